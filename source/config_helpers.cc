@@ -28,8 +28,11 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "config_helpers.h"
+#include "data_binary.h"
 #include "utils/fileutil.h"
 #include "utils/csv.h"
+#include "utils/mmap.h"
+#include "utils/parallel.h"
 #include "utils/algo.h"
 #include <iostream>
 
@@ -204,51 +207,177 @@ ReturnCode configure_direction(
   return parseEnum(defs, prop.value, value);
 }
 
+static const size_t kCSVMinChunkRows = 1 << 16;
+
+static std::vector<std::string_view> load_csv_column(
+    const CSVTable& csv_data,
+    size_t column,
+    size_t row_begin,
+    size_t row_end,
+    std::deque<std::string>* unescaped) {
+  std::vector<std::string_view> values;
+  values.reserve(row_end - row_begin);
+  for (size_t row = row_begin; row < row_end; ++row) {
+    values.emplace_back(csv_cell(csv_data, row, column, unescaped));
+  }
+
+  return values;
+}
+
+/**
+ * Load a CSV file into a list of series. Large files are split into chunks of
+ * rows that are converted in parallel; the per-chunk columns are concatenated
+ * afterwards. If any chunk of a column contains text, the numeric chunks of
+ * that column are converted again from their original text so that the result
+ * does not depend on the chunking.
+ */
 ReturnCode load_csv(
     const std::string& csv_path,
     bool csv_headers,
+    size_t threads,
     SeriesMap* data) {
-  auto csv_data_str = FileUtil::read(csv_path).toString();
-  auto csv_data = CSVData{};
+  MappedFileRef csv_file;
+  if (auto rc = mmap_file(csv_path, &csv_file); !rc) {
+    return rc;
+  }
+
+  CSVTable csv_data;
   CSVParserConfig csv_opts;
-  if (auto rc = parseCSV(csv_data_str, csv_opts, &csv_data); !rc) {
+  csv_opts.threads = threads;
+  if (auto rc = parseCSV(csv_file->data, csv_file->size, csv_opts, &csv_data); !rc) {
     return rc;
   }
 
+  auto row_count = csv_row_count(csv_data);
+
   std::optional<size_t> column_count;
-  for (const auto& row : csv_data) {
-    if (!column_count || row.size() < column_count) {
-      column_count = row.size();
+  for (size_t row = 0; row < row_count; ++row) {
+    auto row_size = csv_column_count(csv_data, row);
+    if (!column_count || row_size < column_count) {
+      column_count = row_size;
     }
   }
 
-  for (size_t i = 0; i < column_count; ++i) {
-    std::string series_name;
+  if (!column_count) {
+    return OK;
+  }
 
-    auto row = csv_data.begin();
-    if (csv_headers &&
-        row != csv_data.end() &&
-        row->size() > i) {
-      series_name = (row++)->at(i);
+  size_t row_begin = csv_headers ? 1 : 0;
+  auto chunk_count = std::clamp(
+      (row_count - row_begin) / kCSVMinChunkRows,
+      size_t(1),
+      parallel_thread_count(threads));
+
+  auto chunk_begin = [&] (size_t chunk) {
+    return row_begin + (row_count - row_begin) * chunk / chunk_count;
+  };
+
+  std::vector<std::vector<Series>> chunks(
+      *column_count,
+      std::vector<Series>(chunk_count));
+
+  parallel_for(chunk_count, threads, [&] (size_t chunk) {
+    for (size_t i = 0; i < *column_count; ++i) {
+      std::deque<std::string> unescaped;
+      auto values = load_csv_column(
+          csv_data,
+          i,
+          chunk_begin(chunk),
+          chunk_begin(chunk + 1),
+          &unescaped);
+
+      chunks[i][chunk] = series_from_text(values);
+    }
+  });
+
+  for (size_t i = 0; i < *column_count; ++i) {
+    std::deque<std::string> unescaped;
+    std::string series_name;
+    if (csv_headers) {
+      series_name = csv_cell(csv_data, 0, i, &unescaped);
     } else {
       series_name = std::to_string(i);
     }
 
-    auto series = std::make_shared<Series>();
-    for (; row != csv_data.end(); ++row) {
-      if (row->size() > i) {
-        series->emplace_back(row->at(i));
-      } else {
-        series->emplace_back();
+    auto& parts = chunks[i];
+    bool is_text = std::any_of(parts.begin(), parts.end(), [] (const auto& p) {
+      return p.type == SeriesType::TEXT;
+    });
+
+    for (size_t chunk = 0; chunk < chunk_count && is_text; ++chunk) {
+      if (parts[chunk].type == SeriesType::TEXT) {
+        continue;
       }
+
+      auto values = load_csv_column(
+          csv_data,
+          i,
+          chunk_begin(chunk),
+          chunk_begin(chunk + 1),
+          &unescaped);
+
+      parts[chunk] = Series();
+      parts[chunk].length = values.size();
+      parts[chunk].text.assign(values.begin(), values.end());
     }
 
-    (*data)[series_name] = series;
+    (*data)[series_name] = std::make_shared<Series>(
+        series_concat(std::move(parts)));
   }
 
   return OK;
 }
 
+ReturnCode load_csv_cached(
+    const std::string& csv_path,
+    bool csv_headers,
+    const DataContext& ctx,
+    SeriesMap* data) {
+  auto& cache = *ctx.file_cache;
+  auto cache_key = std::make_pair(csv_path, csv_headers);
+
+  if (auto table = cache.csv_tables.find(cache_key); table != cache.csv_tables.end()) {
+    ++cache.csv_stats.hits;
+    *data = table->second;
+    return OK;
+  }
+
+  ++cache.csv_stats.misses;
+
+  SeriesMap table;
+  if (auto rc = load_csv(csv_path, csv_headers, ctx.threads, &table); !rc) {
+    return rc;
+  }
+
+  cache.csv_tables.emplace(cache_key, table);
+  *data = std::move(table);
+  return OK;
+}
+
+ReturnCode load_binary_cached(
+    const std::string& path,
+    const DataContext& ctx,
+    SeriesMap* data) {
+  auto& cache = *ctx.file_cache;
+
+  if (auto table = cache.binary_tables.find(path); table != cache.binary_tables.end()) {
+    ++cache.binary_stats.hits;
+    *data = table->second;
+    return OK;
+  }
+
+  ++cache.binary_stats.misses;
+
+  SeriesMap table;
+  if (auto rc = binary_read(path, &table); !rc) {
+    return rc;
+  }
+
+  cache.binary_tables.emplace(path, table);
+  *data = std::move(table);
+  return OK;
+}
+
 ReturnCode parse_datasource_csv(
     const plist::Property& prop ,
     DataContext* ctx) {
@@ -274,7 +403,39 @@ ReturnCode parse_datasource_csv(
     }
   }
 
-  return load_csv(csv_path, csv_headers, &ctx->by_name);
+  SeriesMap csv_data;
+  if (auto rc = load_csv_cached(csv_path, csv_headers, *ctx, &csv_data); !rc) {
+    return rc;
+  }
+
+  for (const auto& column : csv_data) {
+    ctx->by_name[column.first] = column.second;
+  }
+
+  return OK;
+}
+
+ReturnCode parse_datasource_binary(
+    const plist::Property& prop ,
+    DataContext* ctx) {
+  if (!plist::is_enum(prop, "binary")) {
+    return ERROR;
+  }
+
+  if (prop.size() != 1) {
+    return ReturnCode::errorf("EARG", "binary() takes exactly one argument, got: $0", prop.size());
+  }
+
+  SeriesMap binary_data;
+  if (auto rc = load_binary_cached(prop[0].value, *ctx, &binary_data); !rc) {
+    return rc;
+  }
+
+  for (const auto& column : binary_data) {
+    ctx->by_name[column.first] = column.second;
+  }
+
+  return OK;
 }
 
 ReturnCode configure_datasource_prop(
@@ -284,13 +445,17 @@ ReturnCode configure_datasource_prop(
     return parse_datasource_csv(prop, data);
   }
 
+  if (plist::is_enum(prop, "binary")) {
+    return parse_datasource_binary(prop, data);
+  }
+
   return ERROR;
 }
 
 ReturnCode configure_datasource(
     const plist::PropertyList& plist,
     DataContext* data) {
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {"data", bind(&configure_datasource_prop, _1, data)},
   };
 
@@ -313,6 +478,7 @@ ParserFn configure_key(std::string* key) {
 
 ReturnCode parse_data_series_csv(
     const plist::Property& prop,
+    const DataContext& ctx,
     SeriesRef* data_ref) {
   if (!plist::is_enum(prop, "csv")) {
     return ERROR;
@@ -334,7 +500,7 @@ ReturnCode parse_data_series_csv(
   }
 
   SeriesMap csv_data;
-  if (auto rc = load_csv(csv_path, csv_headers, &csv_data); !rc) {
+  if (auto rc = load_csv_cached(csv_path, csv_headers, ctx, &csv_data); !rc) {
     return rc;
   }
 
@@ -351,6 +517,39 @@ ReturnCode parse_data_series_csv(
   }
 }
 
+ReturnCode parse_data_series_binary(
+    const plist::Property& prop,
+    const DataContext& ctx,
+    SeriesRef* data_ref) {
+  if (!plist::is_enum(prop, "binary")) {
+    return ERROR;
+  }
+
+  if (prop.size() != 2) {
+    return ReturnCode::errorf("EARG", "binary() takes exactly two arguments, got: $0", prop.size());
+  }
+
+  const auto& binary_path = prop[0].value;
+  const auto& binary_column = prop[1].value;
+
+  SeriesMap binary_data;
+  if (auto rc = load_binary_cached(binary_path, ctx, &binary_data); !rc) {
+    return rc;
+  }
+
+  *data_ref = find_maybe(binary_data, binary_column);
+
+  if (*data_ref) {
+    return OK;
+  } else {
+    return ReturnCode::errorf(
+        "EARG",
+        "binary file '$0' has no column named '$1'",
+        binary_path,
+        binary_column);
+  }
+}
+
 ReturnCode parse_data_series_inline(
     const plist::Property& prop,
     SeriesRef* data_ref) {
@@ -358,12 +557,12 @@ ReturnCode parse_data_series_inline(
     return ERROR;
   }
 
-  auto data = std::make_shared<Series>();
+  std::vector<Value> values;
   for (const auto& value : *prop.next) {
-    data->emplace_back(value);
+    values.emplace_back(value);
   }
 
-  *data_ref = data;
+  *data_ref = std::make_shared<Series>(series_from_text(std::move(values)));
   return OK;
 }
 
@@ -376,7 +575,11 @@ ReturnCode parse_data_series_var(
   }
 
   const auto& var_name = prop.value;
-  auto var_data = find_maybe(ctx.by_name, var_name);
+  auto var_data = find_maybe(ctx.vars, var_name);
+  if (!var_data) {
+    var_data = find_maybe(ctx.by_name, var_name);
+  }
+
   if (!var_data) {
     return ReturnCode::errorf("EARG", "variable not found: '$0'", var_name);
   }
@@ -390,7 +593,11 @@ ReturnCode configure_series(
     const DataContext& ctx,
     SeriesRef* data) {
   if (plist::is_enum(prop, "csv")) {
-    return parse_data_series_csv(prop, data);
+    return parse_data_series_csv(prop, ctx, data);
+  }
+
+  if (plist::is_enum(prop, "binary")) {
+    return parse_data_series_binary(prop, ctx, data);
   }
 
   if (plist::is_enum(prop, "inline")) {
@@ -0,0 +1,312 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+#include "data_binary.h"
+#include "utils/mmap.h"
+
+namespace plotfx {
+
+/**
+ * The file format is little-endian; values are byte swapped on big-endian
+ * hosts
+ */
+static const bool kBinaryHostBigEndian =
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+static const char kBinaryMagic[8] = { 'P', 'L', 'O', 'T', 'F', 'X', 'B', '1' };
+static const uint32_t kBinaryVersion = 1;
+static const size_t kBinaryHeaderSize = 16;
+static const size_t kBinaryColumnSize = 40;
+
+enum BinaryType : uint32_t {
+  BINARY_TEXT = 0,
+  BINARY_FLOAT64 = 1,
+  BINARY_INT64 = 2,
+};
+
+template <typename T>
+static T binary_swap(T value) {
+  if (kBinaryHostBigEndian) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    std::reverse(bytes, bytes + sizeof(T));
+    memcpy(&value, bytes, sizeof(T));
+  }
+
+  return value;
+}
+
+template <typename T>
+static T binary_load(const char* data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return binary_swap(value);
+}
+
+template <typename T>
+static void binary_store(std::string* data, size_t offset, T value) {
+  value = binary_swap(value);
+  memcpy(data->data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+static void binary_append(std::string* data, T value) {
+  value = binary_swap(value);
+  data->append((const char*) &value, sizeof(T));
+}
+
+template <typename T>
+static void binary_append_array(std::string* data, const T* values, size_t count) {
+  if (!kBinaryHostBigEndian) {
+    data->append((const char*) values, count * sizeof(T));
+    return;
+  }
+
+  data->reserve(data->size() + count * sizeof(T));
+  for (size_t i = 0; i < count; ++i) {
+    binary_append(data, values[i]);
+  }
+}
+
+static void binary_align(std::string* data) {
+  data->resize((data->size() + 7) & ~size_t(7));
+}
+
+static bool binary_check_range(size_t size, uint64_t offset, uint64_t len) {
+  return offset <= size && len <= size - offset;
+}
+
+template <typename T>
+static bool binary_read_array(
+    const MappedFile& file,
+    uint64_t offset,
+    uint64_t count,
+    std::vector<T>* values) {
+  if (count > file.size / sizeof(T) ||
+      !binary_check_range(file.size, offset, count * sizeof(T))) {
+    return false;
+  }
+
+  values->resize(count);
+  memcpy(values->data(), file.data + offset, count * sizeof(T));
+
+  if (kBinaryHostBigEndian) {
+    for (auto& v : *values) {
+      v = binary_swap(v);
+    }
+  }
+
+  return true;
+}
+
+static bool binary_read_text(
+    const MappedFile& file,
+    uint64_t offset,
+    uint64_t count,
+    std::vector<Value>* values) {
+  std::vector<uint64_t> offsets;
+  if (count >= file.size / sizeof(uint64_t) ||
+      !binary_read_array(file, offset, count + 1, &offsets)) {
+    return false;
+  }
+
+  auto base = offset + offsets.size() * sizeof(uint64_t);
+  values->reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto begin = offsets[i];
+    auto end = offsets[i + 1];
+    if (begin > end || !binary_check_range(file.size, base + begin, end - begin)) {
+      return false;
+    }
+
+    values->emplace_back(file.data + base + begin, end - begin);
+  }
+
+  return true;
+}
+
+ReturnCode binary_read(
+    const std::string& path,
+    SeriesMap* data) {
+  MappedFileRef file;
+  if (auto rc = mmap_file(path, &file); !rc) {
+    return rc;
+  }
+
+  auto error = [&path] (const std::string& reason) {
+    return ReturnCode::errorf(
+        "EIO",
+        "invalid binary data file '$0': $1",
+        path,
+        reason);
+  };
+
+  if (file->size < kBinaryHeaderSize ||
+      memcmp(file->data, kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+    return error("bad header");
+  }
+
+  auto version = binary_load<uint32_t>(file->data + 8);
+  if (version != kBinaryVersion) {
+    return error(StringUtil::format("unsupported version: $0", version));
+  }
+
+  auto column_count = binary_load<uint32_t>(file->data + 12);
+  if (!binary_check_range(
+          file->size,
+          kBinaryHeaderSize,
+          uint64_t(column_count) * kBinaryColumnSize)) {
+    return error("truncated column directory");
+  }
+
+  for (size_t i = 0; i < column_count; ++i) {
+    auto entry = file->data + kBinaryHeaderSize + i * kBinaryColumnSize;
+    auto name_offset = binary_load<uint64_t>(entry);
+    auto name_length = binary_load<uint32_t>(entry + 8);
+    auto type = binary_load<uint32_t>(entry + 12);
+    auto data_offset = binary_load<uint64_t>(entry + 16);
+    auto length = binary_load<uint64_t>(entry + 24);
+    auto validity_offset = binary_load<uint64_t>(entry + 32);
+
+    if (!binary_check_range(file->size, name_offset, name_length)) {
+      return error("truncated column name");
+    }
+
+    std::string name(file->data + name_offset, name_length);
+
+    Series s;
+    s.length = length;
+
+    bool valid = false;
+    switch (type) {
+      case BINARY_TEXT:
+        s.type = SeriesType::TEXT;
+        valid = binary_read_text(*file, data_offset, length, &s.text);
+        break;
+      case BINARY_FLOAT64:
+        s.type = SeriesType::FLOAT64;
+        valid = binary_read_array(*file, data_offset, length, &s.f64);
+        break;
+      case BINARY_INT64:
+        s.type = SeriesType::INT64;
+        valid = binary_read_array(*file, data_offset, length, &s.i64);
+        break;
+      default:
+        return error(StringUtil::format("unknown type of column '$0'", name));
+    }
+
+    if (!valid) {
+      return error(StringUtil::format("truncated column '$0'", name));
+    }
+
+    if (validity_offset > 0 &&
+        !binary_read_array(
+            *file,
+            validity_offset,
+            (length + 63) / 64,
+            &s.validity)) {
+      return error(StringUtil::format("truncated validity of column '$0'", name));
+    }
+
+    (*data)[name] = std::make_shared<Series>(std::move(s));
+  }
+
+  return OK;
+}
+
+ReturnCode binary_write(
+    const std::string& path,
+    const std::vector<BinaryColumn>& columns) {
+  std::string data(kBinaryMagic, sizeof(kBinaryMagic));
+  binary_append<uint32_t>(&data, kBinaryVersion);
+  binary_append<uint32_t>(&data, columns.size());
+  data.resize(kBinaryHeaderSize + columns.size() * kBinaryColumnSize);
+
+  for (size_t i = 0; i < columns.size(); ++i) {
+    const auto& name = columns[i].first;
+    const auto& s = *columns[i].second;
+    auto entry = kBinaryHeaderSize + i * kBinaryColumnSize;
+
+    binary_store<uint64_t>(&data, entry, data.size());
+    binary_store<uint32_t>(&data, entry + 8, name.size());
+    data += name;
+    binary_align(&data);
+
+    binary_store<uint64_t>(&data, entry + 16, data.size());
+    binary_store<uint64_t>(&data, entry + 24, s.length);
+
+    switch (s.type) {
+      case SeriesType::TEXT: {
+        binary_store<uint32_t>(&data, entry + 12, BINARY_TEXT);
+        uint64_t offset = 0;
+        binary_append<uint64_t>(&data, offset);
+        for (const auto& v : s.text) {
+          offset += v.size();
+          binary_append<uint64_t>(&data, offset);
+        }
+
+        for (const auto& v : s.text) {
+          data += v;
+        }
+        break;
+      }
+      case SeriesType::FLOAT64:
+        binary_store<uint32_t>(&data, entry + 12, BINARY_FLOAT64);
+        binary_append_array(&data, series_f64(s), s.length);
+        break;
+      case SeriesType::INT64:
+        binary_store<uint32_t>(&data, entry + 12, BINARY_INT64);
+        binary_append_array(&data, s.i64.data(), s.i64.size());
+        break;
+    }
+
+    binary_align(&data);
+
+    if (s.validity.empty()) {
+      binary_store<uint64_t>(&data, entry + 32, 0);
+    } else {
+      binary_store<uint64_t>(&data, entry + 32, data.size());
+      binary_append_array(&data, s.validity.data(), s.validity.size());
+    }
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(data.data(), data.size());
+  if (!file) {
+    return ReturnCode::errorf("EIO", "unable to write file '$0'", path);
+  }
+
+  return OK;
+}
+
+} // namespace plotfx
+
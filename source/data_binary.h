@@ -0,0 +1,78 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "source/data_model.h"
+#include "utils/return_code.h"
+
+namespace plotfx {
+
+/**
+ * A simple self-describing columnar file format that can be memory mapped and
+ * read into typed series without any text conversion. All integers and floats
+ * are stored little-endian (they are byte swapped on big-endian hosts); all
+ * sections start at a multiple of eight bytes.
+ *
+ *   header (16 bytes):
+ *     magic         char[8]   "PLOTFXB1"
+ *     version       uint32    1
+ *     column_count  uint32
+ *
+ *   column directory (column_count entries of 40 bytes):
+ *     name_offset      uint64  offset of the column name
+ *     name_length      uint32
+ *     type             uint32  0 = text, 1 = float64, 2 = int64
+ *     data_offset      uint64  offset of the column data
+ *     length           uint64  number of values
+ *     validity_offset  uint64  offset of the validity bitmap, 0 = all valid
+ *
+ * Numeric column data is an array of `length` values. Text column data is an
+ * array of `length + 1` uint64 offsets relative to the end of the array,
+ * followed by the concatenated values. The validity bitmap is an array of
+ * `ceil(length / 64)` uint64 words; bit `i % 64` of word `i / 64` is set if
+ * value `i` is present.
+ *
+ * Numeric columns store only their values, like numeric series, so "1.50" is
+ * read back as 1.5 and labelled "1.5".
+ */
+using BinaryColumn = std::pair<std::string, SeriesRef>;
+
+ReturnCode binary_read(
+    const std::string& path,
+    SeriesMap* data);
+
+ReturnCode binary_write(
+    const std::string& path,
+    const std::vector<BinaryColumn>& columns);
+
+} // namespace plotfx
+
@@ -28,38 +28,493 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "data_model.h"
+#include <algorithm>
 #include <assert.h>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <ctype.h>
+#include <string.h>
 #include <iostream>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace plotfx {
 
-size_t series_len(const Series& s) {
-  return s.size();
+DataContext::DataContext() :
+    file_cache(std::make_shared<DataFileCache>()),
+    threads(1) {}
+
+SeriesSummary::SeriesSummary() :
+    length(0) {}
+
+Series::Series() :
+    type(SeriesType::TEXT),
+    length(0),
+    parse_errors(0),
+    f64_borrowed(nullptr),
+    cache_projections(false) {}
+
+/**
+ * Strip leading whitespace and a leading plus sign, which std::stod accepts
+ * but std::from_chars does not
+ */
+static std::string_view number_strip_prefix(std::string_view v) {
+  while (!v.empty() && isspace(v[0])) {
+    v.remove_prefix(1);
+  }
+
+  if (v.size() > 1 && v[0] == '+' && v[1] != '-') {
+    v.remove_prefix(1);
+  }
+
+  return v;
 }
 
-bool series_is_numeric(const Series& s) {
-  for (const auto& v : s) {
-    if (!StringUtil::isNumber(v)) {
-      size_t idx;
-      try {
-        std::stod(v, &idx);
-      } catch (...) {
-        return false;
+bool value_parse_int(std::string_view v, int64_t* value) {
+  v = number_strip_prefix(v);
+  auto end = v.data() + v.size();
+  auto res = std::from_chars(v.data(), end, *value);
+  return res.ec == std::errc() && res.ptr == end;
+}
+
+bool value_parse_float(std::string_view v, double* value) {
+  v = number_strip_prefix(v);
+  auto end = v.data() + v.size();
+  auto res = std::from_chars(v.data(), end, *value);
+  return res.ec == std::errc() && res.ptr == end;
+}
+
+static void series_set_invalid(Series* s, size_t idx) {
+  if (s->validity.empty()) {
+    s->validity.resize((s->length + 63) / 64, ~uint64_t(0));
+  }
+
+  s->validity[idx / 64] &= ~(uint64_t(1) << (idx % 64));
+}
+
+/**
+ * Convert a list of text values into a numeric series in a single pass.
+ * Returns a series of type TEXT (without copying the values) if any value is
+ * not a number; the scan continues in that case to count all parse errors.
+ */
+template <typename T>
+static Series series_parse(const std::vector<T>& values) {
+  Series s;
+  s.type = SeriesType::INT64;
+  s.length = values.size();
+  s.i64.reserve(values.size());
+
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    std::string_view v = values[idx];
+
+    if (s.parse_errors > 0) {
+      double vf;
+      if (!v.empty() && !value_parse_float(v, &vf)) {
+        ++s.parse_errors;
+      }
+
+      continue;
+    }
+
+    if (v.empty()) {
+      series_set_invalid(&s, idx);
+
+      if (s.type == SeriesType::INT64) {
+        s.i64.push_back(0);
+      } else {
+        s.f64.push_back(0);
+      }
+
+      continue;
+    }
+
+    if (s.type == SeriesType::INT64) {
+      int64_t vi;
+      if (value_parse_int(v, &vi)) {
+        s.i64.push_back(vi);
+        continue;
       }
 
-      if (idx != v.size()) {
-        return false;
+      s.type = SeriesType::FLOAT64;
+      s.f64.reserve(values.size());
+      s.f64.assign(s.i64.begin(), s.i64.end());
+      s.i64 = std::vector<int64_t>();
+    }
+
+    double vf;
+    if (value_parse_float(v, &vf)) {
+      s.f64.push_back(vf);
+      continue;
+    }
+
+    s.parse_errors = 1;
+  }
+
+  if (s.parse_errors > 0) {
+    Series text;
+    text.length = values.size();
+    text.parse_errors = s.parse_errors;
+    return text;
+  }
+
+  return s;
+}
+
+Series series_from_text(std::vector<Value> values) {
+  auto s = series_parse(values);
+  if (s.type == SeriesType::TEXT) {
+    s.text = std::move(values);
+  }
+
+  return s;
+}
+
+Series series_from_text(const std::vector<std::string_view>& values) {
+  auto s = series_parse(values);
+  if (s.type == SeriesType::TEXT) {
+    s.text.assign(values.begin(), values.end());
+  }
+
+  return s;
+}
+
+Series series_from_float(std::vector<double> values) {
+  Series s;
+  s.type = SeriesType::FLOAT64;
+  s.length = values.size();
+  s.f64 = std::move(values);
+  return s;
+}
+
+Series series_concat(std::vector<Series> parts) {
+  if (parts.size() == 1) {
+    return std::move(parts[0]);
+  }
+
+  Series s;
+  s.type = SeriesType::INT64;
+  for (const auto& p : parts) {
+    s.length += p.length;
+    s.parse_errors += p.parse_errors;
+
+    if (p.type == SeriesType::TEXT ||
+        (p.type == SeriesType::FLOAT64 && s.type == SeriesType::INT64)) {
+      s.type = p.type;
+    }
+  }
+
+  size_t offset = 0;
+  for (const auto& p : parts) {
+    switch (s.type) {
+      case SeriesType::TEXT:
+        for (size_t idx = 0; idx < p.length; ++idx) {
+          s.text.emplace_back(series_value_at(p, idx));
+        }
+        offset += p.length;
+        continue;
+      case SeriesType::FLOAT64:
+        if (p.type == SeriesType::FLOAT64) {
+          s.f64.insert(s.f64.end(), series_f64(p), series_f64(p) + p.length);
+        } else {
+          s.f64.insert(s.f64.end(), p.i64.begin(), p.i64.end());
+        }
+        break;
+      case SeriesType::INT64:
+        s.i64.insert(s.i64.end(), p.i64.begin(), p.i64.end());
+        break;
+    }
+
+    for (size_t idx = 0; idx < p.length && !p.validity.empty(); ++idx) {
+      if (!series_is_valid(p, idx)) {
+        series_set_invalid(&s, offset + idx);
       }
     }
+
+    offset += p.length;
+  }
+
+  return s;
+}
+
+Series series_borrow_float(const double* values, size_t count) {
+  Series s;
+  s.type = SeriesType::FLOAT64;
+  s.length = count;
+  s.f64_borrowed = values;
+  return s;
+}
+
+ReturnCode series_append_float(
+    Series* s,
+    const double* values,
+    size_t count) {
+  switch (s->type) {
+    case SeriesType::TEXT:
+      if (s->length > 0) {
+        return ReturnCode::error("EARG", "can't append numbers to a text series");
+      }
+      break;
+    case SeriesType::INT64:
+      s->f64.assign(s->i64.begin(), s->i64.end());
+      s->i64 = std::vector<int64_t>();
+      break;
+    case SeriesType::FLOAT64:
+      if (s->f64_borrowed) {
+        s->f64.assign(s->f64_borrowed, s->f64_borrowed + s->length);
+        s->f64_borrowed = nullptr;
+      }
+      break;
   }
 
-  return true;
+  s->type = SeriesType::FLOAT64;
+  s->f64.insert(s->f64.end(), values, values + count);
+  s->length += count;
+  s->cache_projections = true;
+
+  if (!s->validity.empty()) {
+    s->validity.resize((s->length + 63) / 64, ~uint64_t(0));
+  }
+
+  return OK;
+}
+
+template <typename T>
+static void series_summarize(
+    const Series& s,
+    const T& value_at,
+    SeriesSummary* summary) {
+  for (size_t i = summary->length; i < s.length; ++i) {
+    if (!series_is_valid(s, i)) {
+      continue;
+    }
+
+    double d = value_at(i);
+    if (std::isnan(d)) {
+      continue;
+    }
+
+    if (!summary->min || *summary->min > d) {
+      summary->min = d;
+    }
+
+    if (!summary->max || *summary->max < d) {
+      summary->max = d;
+    }
+  }
+
+  summary->length = s.length;
+}
+
+/**
+ * Extend min/max by the values in [begin, end). NaN values are skipped by all
+ * paths: comparisons with NaN are false and minpd/maxpd return the second
+ * operand if either operand is NaN.
+ */
+static void series_summarize_f64(
+    const double* values,
+    size_t begin,
+    size_t end,
+    double* min,
+    double* max) {
+  size_t i = begin;
+
+#ifdef __SSE2__
+  if (end - begin >= 8) {
+    auto min0 = _mm_set1_pd(*min);
+    auto min1 = min0;
+    auto max0 = _mm_set1_pd(*max);
+    auto max1 = max0;
+
+    for (; i + 4 <= end; i += 4) {
+      auto v0 = _mm_loadu_pd(values + i);
+      auto v1 = _mm_loadu_pd(values + i + 2);
+      min0 = _mm_min_pd(v0, min0);
+      min1 = _mm_min_pd(v1, min1);
+      max0 = _mm_max_pd(v0, max0);
+      max1 = _mm_max_pd(v1, max1);
+    }
+
+    double mins[2];
+    double maxs[2];
+    _mm_storeu_pd(mins, _mm_min_pd(min0, min1));
+    _mm_storeu_pd(maxs, _mm_max_pd(max0, max1));
+    *min = std::min(mins[0], mins[1]);
+    *max = std::max(maxs[0], maxs[1]);
+  }
+#endif
+
+  for (; i < end; ++i) {
+    auto d = values[i];
+    if (d < *min) {
+      *min = d;
+    }
+
+    if (d > *max) {
+      *max = d;
+    }
+  }
+}
+
+/**
+ * Vectorized summary of a float64 series. Blocks of 64 values whose validity
+ * word is all ones are processed with SIMD, other blocks value by value.
+ */
+static void series_summarize_f64(const Series& s, SeriesSummary* summary) {
+  auto values = series_f64(s);
+  auto min = std::numeric_limits<double>::infinity();
+  auto max = -std::numeric_limits<double>::infinity();
+
+  if (s.validity.empty()) {
+    series_summarize_f64(values, summary->length, s.length, &min, &max);
+  } else {
+    for (size_t i = summary->length; i < s.length; ) {
+      auto word = s.validity[i / 64];
+      auto block_end = std::min((i / 64 + 1) * 64, s.length);
+
+      if (word == ~uint64_t(0)) {
+        series_summarize_f64(values, i, block_end, &min, &max);
+      } else {
+        for (size_t j = i; j < block_end; ++j) {
+          if ((word >> (j % 64)) & 1) {
+            series_summarize_f64(values, j, j + 1, &min, &max);
+          }
+        }
+      }
+
+      i = block_end;
+    }
+  }
+
+  /* min > max iff no values were summarized */
+  if (min <= max) {
+    summary->min = summary->min ? std::min(*summary->min, min) : min;
+    summary->max = summary->max ? std::max(*summary->max, max) : max;
+  }
+
+  summary->length = s.length;
+}
+
+const SeriesSummary& series_summarize(const Series& s) {
+  auto summary = &s.summary;
+  if (summary->length == s.length) {
+    return *summary;
+  }
+
+  switch (s.type) {
+    case SeriesType::FLOAT64:
+      series_summarize_f64(s, summary);
+      break;
+    case SeriesType::INT64: {
+      auto values = s.i64.data();
+      series_summarize(s, [values] (size_t i) { return double(values[i]); }, summary);
+      break;
+    }
+    case SeriesType::TEXT: {
+      auto values = s.text.data();
+      series_summarize(s, [values] (size_t i) { return value_to_float(values[i]); }, summary);
+      break;
+    }
+  }
+
+  return *summary;
+}
+
+static void series_encode(SeriesSummary* summary, const Value& v) {
+  auto code = summary->dict_index.find(v);
+  if (code == summary->dict_index.end()) {
+    code = summary->dict_index.emplace(v, summary->dict.size()).first;
+    summary->dict.emplace_back(v);
+  }
+
+  summary->codes.push_back(code->second);
+}
+
+const SeriesSummary& series_dictionary(const Series& s) {
+  auto summary = &s.summary;
+  if (summary->codes.size() == s.length) {
+    return *summary;
+  }
+
+  summary->codes.reserve(s.length);
+  for (size_t i = summary->codes.size(); i < s.length; ++i) {
+    if (s.type == SeriesType::TEXT) {
+      series_encode(summary, s.text[i]);
+    } else {
+      series_encode(summary, series_value_at(s, i));
+    }
+  }
+
+  return *summary;
+}
+
+size_t series_len(const Series& s) {
+  return s.length;
+}
+
+bool series_is_numeric(const Series& s) {
+  return s.type != SeriesType::TEXT;
+}
+
+const double* series_f64(const Series& s) {
+  return s.f64_borrowed ? s.f64_borrowed : s.f64.data();
+}
+
+bool series_is_valid(const Series& s, size_t idx) {
+  return s.validity.empty() || (s.validity[idx / 64] >> (idx % 64)) & 1;
+}
+
+Value series_value_at(const Series& s, size_t idx) {
+  if (!series_is_valid(s, idx)) {
+    return {};
+  }
+
+  switch (s.type) {
+    case SeriesType::TEXT:
+      return s.text[idx];
+    case SeriesType::INT64:
+      return std::to_string(s.i64[idx]);
+    case SeriesType::FLOAT64: {
+      char buf[64];
+      auto res = std::to_chars(buf, buf + sizeof(buf), series_f64(s)[idx]);
+      return Value(buf, res.ptr);
+    }
+  }
+
+  return {};
+}
+
+std::vector<Value> series_to_text(const Series& s) {
+  if (s.type == SeriesType::TEXT) {
+    return s.text;
+  }
+
+  std::vector<Value> st;
+  st.reserve(s.length);
+
+  for (size_t idx = 0; idx < s.length; ++idx) {
+    st.emplace_back(series_value_at(s, idx));
+  }
+
+  return st;
 }
 
 std::vector<double> series_to_float(const Series& s) {
+  switch (s.type) {
+    case SeriesType::FLOAT64:
+      return std::vector<double>(series_f64(s), series_f64(s) + s.length);
+    case SeriesType::INT64:
+      return std::vector<double>(s.i64.begin(), s.i64.end());
+    case SeriesType::TEXT:
+      break;
+  }
+
   std::vector<double> sf;
+  sf.reserve(s.length);
 
-  for (const auto& v : s) {
+  for (const auto& v : s.text) {
     sf.push_back(value_to_float(v));
   }
 
@@ -67,33 +522,29 @@ std::vector<double> series_to_float(const Series& s) {
 }
 
 double value_to_float(const Value& v) {
-  try {
-    return std::stod(v);
-  } catch (...) {
-    return 0;
-  }
+  auto end = v.data() + v.size();
+  auto number = number_strip_prefix(v);
+  double value;
+  auto res = std::from_chars(number.data(), end, value);
+  return res.ec == std::errc() ? value : 0;
 }
 
 Value value_from_float(double v) {
-  return std::to_string(v);
+  char buf[512];
+  auto res = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, 6);
+  return Value(buf, res.ptr);
 }
 
 std::vector<DataGroup> series_group(const Series& data) {
-  std::vector<DataGroup> groups;
-  std::unordered_map<Value, size_t> group_map;
+  const auto& dict = series_dictionary(data);
 
-  for (size_t idx = 0; idx < data.size(); ++idx) {
-    size_t group_idx = group_map[data[idx]];
-    if (!group_idx) {
-      DataGroup g;
-      g.key = data[idx];
-      groups.emplace_back(g);
-      group_idx = groups.size();
-      group_map[data[idx]] = group_idx;
-    }
+  std::vector<DataGroup> groups(dict.dict.size());
+  for (size_t i = 0; i < groups.size(); ++i) {
+    groups[i].key = dict.dict[i];
+  }
 
-    assert(group_idx > 0);
-    groups[group_idx - 1].index.push_back(idx);
+  for (size_t idx = 0; idx < data.length; ++idx) {
+    groups[dict.codes[idx]].index.push_back(idx);
   }
 
   return groups;
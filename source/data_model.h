@@ -28,20 +28,136 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #pragma once
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdint.h>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
+#include "source/utils/lru_cache.h"
 #include "source/utils/return_code.h"
 
 namespace plotfx {
 
 using Value = std::string;
-using Series = std::vector<Value>;
+
+enum class SeriesType {
+  TEXT, FLOAT64, INT64
+};
+
+/**
+ * Summary of the values of a series that is used to fit domains. The summary
+ * is extended incrementally: `length` is the number of values that have been
+ * included in the min/max summary, so when a series grows only the new values
+ * are scanned. NaN values are ignored.
+ *
+ * The dictionary encoding interns each distinct value once: `dict` holds the
+ * distinct values in order of first occurrence and `codes` the index into
+ * `dict` for each value (invalid values are encoded as the empty string).
+ * Grouping, categorical domains and color assignment work on the codes so
+ * that each value is only hashed once per series.
+ */
+struct SeriesSummary {
+  SeriesSummary();
+  size_t length;
+  std::optional<double> min;
+  std::optional<double> max;
+  std::vector<Value> dict;
+  std::unordered_map<Value, uint32_t> dict_index;
+  std::vector<uint32_t> codes;
+};
+
+/**
+ * Maximum number of projections that are cached per series (see
+ * `SeriesProjection`)
+ */
+static const size_t kSeriesProjectionCacheSize = 4;
+
+/**
+ * Screen coordinates of a series that were computed by `domain_project`.
+ * `params` identifies the domain and the screen range; `values` holds the
+ * coordinates of the first `values.size()` values of the series.
+ */
+struct SeriesProjection {
+  std::vector<double> params;
+  std::vector<double> values;
+};
+
+/**
+ * A single column of data. Numeric columns are stored in a contiguous double
+ * or int64 buffer and the text buffer is only populated if the column really
+ * contains text. Missing (empty) values in numeric columns are tracked in the
+ * validity bitmap; an empty bitmap means that all values are valid.
+ *
+ * The source text of numeric values is not kept: labels, categorical domains
+ * and group keys of a numeric column are formatted from the typed values, so
+ * "1.50" is shown as "1.5" and "007" as "7".
+ *
+ * `parse_errors` is the number of non-empty values that could not be parsed as
+ * a number when the series was built from text.
+ *
+ * A float64 series may borrow its values from a caller-owned buffer instead of
+ * storing them in `f64` (see `plotfx_setvar_f64v_borrowed`). Use `series_f64`
+ * to access float64 data.
+ *
+ * Series are immutable once they are shared, except that `series_append_float`
+ * may grow a series that is owned by the C API context. The summary is a cache
+ * and is updated lazily by `series_summarize` and `series_dictionary`.
+ *
+ * Series that were grown by `series_append_float` also cache their last
+ * projections onto the screen (`cache_projections`), so that a live chart only
+ * projects the appended values as long as the domain stays the same.
+ */
+struct Series {
+  Series();
+  SeriesType type;
+  size_t length;
+  std::vector<double> f64;
+  std::vector<int64_t> i64;
+  std::vector<Value> text;
+  std::vector<uint64_t> validity;
+  size_t parse_errors;
+  const double* f64_borrowed;
+  mutable SeriesSummary summary;
+  bool cache_projections;
+  mutable std::vector<SeriesProjection> projections;
+};
+
 using SeriesRef = std::shared_ptr<const Series>;
 using SeriesMap = std::unordered_map<std::string, SeriesRef>;
 
+/**
+ * Document-scoped cache of loaded data files, so that all `csv(...)` and
+ * `binary(...)` references in a document resolve against a single load of
+ * each file. CSV files are keyed by path and header mode. The hit and miss
+ * counters are reported through `plotfx_getstat`.
+ */
+struct DataFileCache {
+  std::map<std::pair<std::string, bool>, SeriesMap> csv_tables;
+  std::map<std::string, SeriesMap> binary_tables;
+  CacheStats csv_stats;
+  CacheStats binary_stats;
+};
+
 struct DataContext {
+  DataContext();
   SeriesMap by_name;
   SeriesMap defaults;
+  std::shared_ptr<DataFileCache> file_cache;
+
+  /**
+   * Variables set through the C API. They take precedence over variables of
+   * the same name defined in the configuration
+   */
+  SeriesMap vars;
+
+  /**
+   * The number of threads used to load data files; zero means one thread per
+   * core
+   */
+  size_t threads;
 };
 
 struct DataGroup {
@@ -49,14 +165,78 @@ struct DataGroup {
   std::vector<size_t> index;
 };
 
+/**
+ * Build a series from a list of text values. The column type is detected
+ * once: if all non-empty values are integers the series is stored as int64,
+ * if they are all numbers as double, otherwise as text.
+ */
+Series series_from_text(std::vector<Value> values);
+Series series_from_text(const std::vector<std::string_view>& values);
+
+Series series_from_float(std::vector<double> values);
+
+/**
+ * Build a float64 series that references the given buffer without copying it.
+ * The buffer must outlive the series.
+ */
+Series series_borrow_float(const double* values, size_t count);
+
+/**
+ * Concatenate a list of series. The result has the widest type of all parts
+ * (int64 < float64 < text); numeric parts of a text result are converted using
+ * `series_value_at`.
+ */
+Series series_concat(std::vector<Series> parts);
+
+/**
+ * Append values to a series in place. Integer series are promoted to float64
+ * and borrowed data is copied first. Returns an error for text series.
+ */
+ReturnCode series_append_float(
+    Series* s,
+    const double* values,
+    size_t count);
+
+/**
+ * Return the summary of the series, extended to the current length
+ */
+const SeriesSummary& series_summarize(const Series& s);
+
+/**
+ * Return the summary of the series with the dictionary encoding extended to
+ * the current length
+ */
+const SeriesSummary& series_dictionary(const Series& s);
+
 std::vector<DataGroup> series_group(const Series& data);
 
 size_t series_len(const Series& s);
 
 bool series_is_numeric(const Series& s);
 
+const double* series_f64(const Series& s);
+
+bool series_is_valid(const Series& s, size_t idx);
+
+Value series_value_at(const Series& s, size_t idx);
+
+std::vector<Value> series_to_text(const Series& s);
+
 std::vector<double> series_to_float(const Series& s);
 
+/**
+ * Parse a number in the C locale without allocating or throwing. Like
+ * `std::stod`, leading whitespace and a leading plus sign are accepted; returns
+ * false unless the rest of the input is a valid number.
+ */
+bool value_parse_int(std::string_view v, int64_t* value);
+bool value_parse_float(std::string_view v, double* value);
+
+/**
+ * Convert a value to a number. Like `strtod`, leading whitespace and trailing
+ * non-numeric characters are ignored; returns zero if the value does not start
+ * with a number.
+ */
 double value_to_float(const Value&);
 Value value_from_float(double);
 
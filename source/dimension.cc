@@ -43,10 +43,11 @@ std::vector<Color> series_to_colors(
   auto domain = domain_config;
   domain_fit(*series, &domain);
 
+  auto cardinality = domain_cardinality(domain);
+
   std::vector<Color> colors;
-  for (const auto& v : *series) {
-    auto value = domain_translate(domain, v) * domain_cardinality(domain);
-    colors.emplace_back(palette.get(value));
+  for (const auto& v : domain_translate(domain, *series)) {
+    colors.emplace_back(palette.get(v * cardinality));
   }
 
   return colors;
@@ -68,6 +69,65 @@ std::vector<Color> groups_to_colors(
   return colors;
 }
 
+void groups_to_colors_extend(
+    size_t count,
+    const std::vector<DataGroup>& groups,
+    const ColorScheme& palette,
+    std::vector<Color>* colors) {
+  auto first = colors->size();
+  if (first >= count) {
+    return;
+  }
+
+  colors->resize(count);
+  for (size_t gi = 0; gi < groups.size(); ++gi) {
+    const auto& index = groups[gi].index;
+    for (auto i = index.rbegin(); i != index.rend() && *i >= first; ++i) {
+      if (*i < count) {
+        (*colors)[*i] = palette.get(gi);
+      }
+    }
+  }
+}
+
+ReturnCode groups_extend(
+    SeriesRef group,
+    size_t count,
+    std::vector<DataGroup>* groups) {
+  if (!group) {
+    if (groups->size() != 1) {
+      return ERROR;
+    }
+
+    auto& index = groups->front().index;
+    for (size_t i = index.size(); i < count; ++i) {
+      index.push_back(i);
+    }
+
+    return OK;
+  }
+
+  if (series_len(*group) < count) {
+    return ERROR;
+  }
+
+  const auto& dict = series_dictionary(*group);
+  if (dict.dict.size() > groups->size()) {
+    return ReturnCode::error("EARG", "the appended values start a new group");
+  }
+
+  size_t grouped = 0;
+  for (const auto& g : *groups) {
+    grouped += g.index.size();
+  }
+
+  for (size_t i = grouped; i < count; ++i) {
+    (*groups)[dict.codes[i]].index.push_back(i);
+  }
+
+  return OK;
+}
+
 std::vector<Measure> series_to_sizes(
     SeriesRef series,
     const DomainConfig& domain_config,
@@ -81,9 +141,8 @@ std::vector<Measure> series_to_sizes(
   domain_fit(*series, &domain);
 
   std::vector<Measure> sizes;
-  for (const auto& v : *series) {
-    auto value = domain_translate(domain, v);
-    sizes.emplace_back(low.value + (high.value - low.value) * value);
+  for (const auto& v : domain_translate(domain, *series)) {
+    sizes.emplace_back(low.value + (high.value - low.value) * v);
   }
 
   return sizes;
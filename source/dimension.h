@@ -46,6 +46,25 @@ std::vector<Color> groups_to_colors(
     const std::vector<DataGroup>& groups,
     const ColorScheme& palette);
 
+/**
+ * Extend colors assigned by `groups_to_colors` to the first `count` values
+ */
+void groups_to_colors_extend(
+    size_t count,
+    const std::vector<DataGroup>& groups,
+    const ColorScheme& palette,
+    std::vector<Color>* colors);
+
+/**
+ * Extend the groups of a layer to the first `count` values after its series
+ * grew in place. Without a group series all values are in a single group.
+ * Returns an error if one of the new values starts a new group
+ */
+ReturnCode groups_extend(
+    SeriesRef group,
+    size_t count,
+    std::vector<DataGroup>* groups);
+
 std::vector<Measure> series_to_sizes(
     SeriesRef series,
     const DomainConfig& domain_config,
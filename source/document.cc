@@ -37,12 +37,20 @@
 #include "graphics/font_lookup.h"
 #include "source/config_helpers.h"
 #include "utils/fileutil.h"
+#include "utils/parallel.h"
 #include "plot.h"
 
 using namespace std::placeholders;
 
 namespace plotfx {
 
+Context::Context() :
+    threads(1),
+    vars_changed(false),
+    vars_appended(false),
+    document_loads(0),
+    document_updates(0) {}
+
 Document::Document() :
     width(1200),
     height(480),
@@ -50,10 +58,34 @@ Document::Document() :
     text_color(Color::fromRGB(.2,.2,.2)),
     border_color(Color::fromRGB(.66,.66,.66)),
     dpi(96),
-    font_size(from_pt(11, dpi)) {}
+    font_size(from_pt(11, dpi)),
+    font_metrics(FontMetricsMode::SYSTEM) {}
+
+static ReturnCode configure_font_metrics(
+    const plist::Property& prop,
+    FontMetricsMode* mode) {
+  if (!plist::is_value(prop)) {
+    return ReturnCode::errorf(
+        "EARG",
+        "incorrect number of arguments; expected: 1, got: $0",
+        prop.size());
+  }
+
+  static const EnumDefinitions<FontMetricsMode> defs = {
+    { "system", FontMetricsMode::SYSTEM },
+    { "embedded", FontMetricsMode::EMBEDDED },
+  };
+
+  return parseEnum(defs, prop.value, mode);
+}
 
 ReturnCode document_setup_defaults(Document* doc) {
-  if (!font_load(DefaultFont::HELVETICA_REGULAR, &doc->font_sans)) {
+  auto rc = font_load(
+      DefaultFont::HELVETICA_REGULAR,
+      doc->font_metrics,
+      &doc->font_sans);
+
+  if (!rc) {
     return ReturnCode::error(
         "EARG",
         "unable to find default sans-sans font (Helvetica/Arial)");
@@ -65,13 +97,24 @@ ReturnCode document_setup_defaults(Document* doc) {
 ReturnCode document_load(
     const PropertyList& plist,
     Document* doc) {
+  // IMPORTANT: the font metrics mode must be known before the default fonts
+  // are loaded
+
+  const ParserDefinitions font_pdefs = {
+    {"font-metrics", bind(&configure_font_metrics, _1, &doc->font_metrics)},
+  };
+
+  if (auto rc = parseAll(plist, font_pdefs); !rc.isSuccess()) {
+    return rc;
+  }
+
   if (auto rc = document_setup_defaults(doc); !rc.isSuccess()) {
     return rc;
   }
 
   // IMPORTANT: parse dpi + font size first
 
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {"font-size", bind(&configure_measure_rel, _1, doc->dpi, doc->font_size, &doc->font_size)},
     {"width", bind(&configure_measure_rel, _1, doc->dpi, doc->font_size, &doc->width)},
     {"height", bind(&configure_measure_rel, _1, doc->dpi, doc->font_size, &doc->height)},
@@ -91,14 +134,15 @@ ReturnCode document_load(
     return rc;
   }
 
-  plot::PlotConfig root_config;
-  if (auto rc = plot::configure(plist, doc->data, *doc, &root_config); !rc) {
-    return rc;
+  return buildElement("plot", plist, doc->data, *doc, &doc->root);
+}
+
+ReturnCode document_update(Document* doc) {
+  if (!doc->root || !doc->root->update) {
+    return ReturnCode::error("EARG", "the document can't be updated");
   }
 
-  doc->root = std::make_unique<Element>();
-  doc->root->draw = bind(&plot::draw, root_config, _1, _2);
-  return OK;
+  return doc->root->update();
 }
 
 ReturnCode document_load(
@@ -136,33 +180,17 @@ ReturnCode document_render_to(
   return ReturnCode::success();
 }
 
-ReturnCode document_render(
-    const Document& doc,
-    const std::string& format,
-    const std::string& filename) {
-  if (format == "svg")
-    return document_render_svg(doc, filename);
-  if (format == "png")
-    return document_render_png(doc, filename);
-
-  return ReturnCode::errorf("EARG", "invalid output format: $0", format);
-}
-
-ReturnCode document_render_svg(
+ReturnCode document_record(
     const Document& doc,
-    const std::string& filename) {
+    DisplayList* list) {
   LayerRef layer;
 
-  auto rc = layer_bind_svg(
+  auto rc = layer_bind_recorder(
       doc.width,
       doc.height,
       doc.dpi,
       doc.font_size,
-      doc.background_color,
-      [filename] (auto svg) {
-        FileUtil::write(filename, Buffer(svg.data(), svg.size()));
-        return OK;
-      },
+      list,
       &layer);
 
   if (!rc.isSuccess()) {
@@ -173,37 +201,118 @@ ReturnCode document_render_svg(
     return rc;
   }
 
+  list->stats = layer->stats;
   return OK;
 }
 
-ReturnCode document_render_png(
+RenderTarget::RenderTarget() : scale(1.0) {}
+
+ReturnCode document_render(
     const Document& doc,
-    const std::string& filename) {
+    const std::string& format,
+    const std::string& filename,
+    RenderStats* stats) {
+  RenderTarget target;
+  target.format = format;
+  target.filename = filename;
+  return document_render_targets(doc, { target }, 1, stats);
+}
+
+static ReturnCode document_render_target(
+    const Document& doc,
+    const DisplayList& list,
+    const RenderTarget& target) {
+  if (!(target.scale > 0)) {
+    return ReturnCode::errorf(
+        "EARG",
+        "invalid output scale for $0: $1",
+        target.filename,
+        target.scale);
+  }
+
   LayerRef layer;
+  auto filename = target.filename;
+  auto submit = [filename] (auto data) {
+    FileUtil::write(filename, Buffer(data.data(), data.size()));
+    return OK;
+  };
 
-  auto rc = layer_bind_png(
-      doc.width,
-      doc.height,
-      doc.dpi,
-      doc.font_size,
-      doc.background_color,
-      [filename] (auto png) {
-        FileUtil::write(filename, Buffer(png.data(), png.size()));
-        return OK;
-      },
-      &layer);
+  auto rc = ReturnCode::success();
+  if (target.format == "svg") {
+    rc = layer_bind_svg(
+        list.width * target.scale,
+        list.height * target.scale,
+        list.dpi,
+        Measure(list.font_size * target.scale),
+        doc.background_color,
+        submit,
+        &layer);
+  } else if (target.format == "png") {
+    rc = layer_bind_png(
+        list.width * target.scale,
+        list.height * target.scale,
+        list.dpi,
+        Measure(list.font_size * target.scale),
+        doc.background_color,
+        submit,
+        &layer);
+  } else {
+    return ReturnCode::errorf("EARG", "invalid output format: $0", target.format);
+  }
 
   if (!rc.isSuccess()) {
     return rc;
   }
 
-  if (auto rc = document_render_to(doc, layer.get()); !rc.isSuccess()) {
+  if (auto rc = display_list_replay(list, target.scale, layer.get()); !rc) {
+    return rc;
+  }
+
+  return layer_submit(layer.get());
+}
+
+ReturnCode document_render_targets(
+    const Document& doc,
+    const std::vector<RenderTarget>& targets,
+    size_t threads,
+    RenderStats* stats) {
+  DisplayList list;
+  if (auto rc = document_record(doc, &list); !rc.isSuccess()) {
     return rc;
   }
 
+  std::vector<ReturnCode> results(targets.size(), ReturnCode::success());
+  parallel_for(targets.size(), threads, [&] (size_t i) {
+    results[i] = document_render_target(doc, list, targets[i]);
+  });
+
+  for (const auto& rc : results) {
+    if (!rc.isSuccess()) {
+      return rc;
+    }
+  }
+
+  if (stats) {
+    *stats = list.stats;
+  }
+
   return OK;
 }
 
+ReturnCode document_render_svg(
+    const Document& doc,
+    const std::string& filename,
+    RenderStats* stats) {
+  return document_render(doc, "svg", filename, stats);
+}
+
+ReturnCode document_render_png(
+    const Document& doc,
+    const std::string& filename,
+    RenderStats* stats) {
+  return document_render(doc, "png", filename, stats);
+}
+
 void ctx_seterrf(plotfx_t* ctx, const std::string& err) {
   static_cast<Context*>(ctx)->error = err;
 }
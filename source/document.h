@@ -35,14 +35,32 @@
 #include "graphics/measure.h"
 #include "graphics/color.h"
 #include "graphics/text.h"
+#include "graphics/layer.h"
+#include "graphics/display_list.h"
+#include "graphics/font_lookup.h"
 #include "element.h"
 
 namespace plotfx {
 class Layer;
 
 struct Context {
+  Context();
   std::unique_ptr<Document> document;
   mutable std::string error;
+  size_t threads;
+  PropertyList config;
+  std::unordered_map<std::string, std::shared_ptr<Series>> vars;
+  bool vars_changed;
+  bool vars_appended;
+  RenderStats stats;
+  size_t document_loads;
+  size_t document_updates;
+
+  /**
+   * Columns of the loaded data files that contain values that are not
+   * numbers, with the number of such values (see `plotfx_getstat`)
+   */
+  std::vector<std::pair<std::string, size_t>> parse_errors;
 };
 
 struct Document {
@@ -60,6 +78,7 @@ struct Document {
   DataContext data;
   double dpi;
   Measure font_size;
+  FontMetricsMode font_metrics;
 };
 
 ReturnCode document_load(
@@ -70,22 +89,62 @@ ReturnCode document_load(
     const std::string& spec,
     Document* tree);
 
+/**
+ * Update a loaded document after the variables it references grew in place
+ * (see `plotfx_append_f64v`). Only the new values are fitted and grouped; the
+ * configuration is not parsed again. Returns an error if the document has to
+ * be loaded again instead, e.g. because the new values start a new group
+ */
+ReturnCode document_update(Document* doc);
+
+/**
+ * An output file. Outputs with a scale other than one are rendered at a
+ * multiple of the document size, e.g. 0.25 for a thumbnail
+ */
+struct RenderTarget {
+  RenderTarget();
+  std::string format;
+  std::string filename;
+  double scale;
+};
+
 ReturnCode document_render(
     const Document& doc,
     const std::string& format,
-    const std::string& filename);
+    const std::string& filename,
+    RenderStats* stats);
 
 ReturnCode document_render_to(
     const Document& tree,
     Layer* layer);
 
+/**
+ * Draw the document into a display list. The display list can then be replayed
+ * to one or more rendering backends using `display_list_replay`
+ */
+ReturnCode document_record(
+    const Document& doc,
+    DisplayList* list);
+
+/**
+ * Draw the document once and write it to all given outputs. The outputs are
+ * rendered on up to `threads` threads (zero means one thread per core)
+ */
+ReturnCode document_render_targets(
+    const Document& doc,
+    const std::vector<RenderTarget>& targets,
+    size_t threads,
+    RenderStats* stats);
+
 ReturnCode document_render_svg(
     const Document& doc,
-    const std::string& filename);
+    const std::string& filename,
+    RenderStats* stats);
 
 ReturnCode document_render_png(
     const Document& doc,
-    const std::string& filename);
+    const std::string& filename,
+    RenderStats* stats);
 
 void ctx_seterrf(plotfx_t* ctx, const std::string& err);
 void ctx_seterr(plotfx_t* ctx, const ReturnCode& err);
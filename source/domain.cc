@@ -32,6 +32,10 @@
 #include <iostream>
 #include "utils/algo.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace plotfx {
 
 static const double kDefaultLogBase = 10;
@@ -42,21 +46,20 @@ DomainConfig::DomainConfig() :
     inverted(false),
     padding(0.1f) {}
 
-void domain_fit_continuous(const Series& data_raw, DomainConfig* domain) {
-  auto data = series_to_float(data_raw);
+void domain_fit_continuous(const Series& data, DomainConfig* domain) {
+  const auto& summary = series_summarize(data);
 
-  for (const auto& d : data) {
-    if (!domain->min_auto || *domain->min_auto > d) {
-      domain->min_auto = std::optional<double>(d);
-    }
-    if (!domain->max_auto || *domain->max_auto < d) {
-      domain->max_auto = std::optional<double>(d);
-    }
+  if (summary.min && (!domain->min_auto || *domain->min_auto > *summary.min)) {
+    domain->min_auto = summary.min;
+  }
+
+  if (summary.max && (!domain->max_auto || *domain->max_auto < *summary.max)) {
+    domain->max_auto = summary.max;
   }
 }
 
 void domain_fit_categorical(const Series& data, DomainConfig* domain) {
-  for (const auto& d : data) {
+  for (const auto& d : series_dictionary(data).dict) {
     if (domain->map.count(d) > 0) {
       continue;
     }
@@ -195,17 +198,340 @@ double domain_translate(
   return 0.0f;
 }
 
-std::vector<double> domain_translate(
+struct DomainScaleLinear {
+  explicit DomainScaleLinear(const DomainConfig& domain) :
+      min(domain_min(domain)),
+      range(domain_max(domain) - min) {}
+
+  double operator()(double v) const {
+    return (v - min) / range;
+  }
+
+  double min;
+  double range;
+};
+
+struct DomainScaleLog {
+  explicit DomainScaleLog(const DomainConfig& domain) :
+      min(domain_min(domain)),
+      base_log(log(domain.log_base.value_or(kDefaultLogBase))),
+      range_log(log(domain_max(domain) - min) / base_log) {}
+
+  double operator()(double v) const {
+    auto vf = v - min;
+    if (vf > 1.0) {
+      vf = log(vf) / base_log;
+    } else {
+      vf = 0;
+    }
+
+    return vf / range_log;
+  }
+
+  double min;
+  double base_log;
+  double range_log;
+};
+
+/**
+ * Translates and projects a typed column in a single pass. The arithmetic is
+ * the same as in the scalar domain_translate followed by the screen transform
+ * in the draw functions, so both paths produce bit-identical coordinates
+ */
+template <typename Scale, bool Inverted, bool Flip, typename T>
+void domain_project_kernel(
+    const Scale& scale,
+    const T* values,
+    size_t count,
+    double origin,
+    double extent,
+    double* projected) {
+  size_t i = 0;
+
+#ifdef __SSE2__
+  if constexpr (
+      std::is_same<Scale, DomainScaleLinear>::value &&
+      std::is_same<T, double>::value) {
+    const auto min = _mm_set1_pd(scale.min);
+    const auto range = _mm_set1_pd(scale.range);
+    const auto zero = _mm_set1_pd(0.0);
+    const auto one = _mm_set1_pd(1.0);
+    const auto origin_v = _mm_set1_pd(origin);
+    const auto extent_v = _mm_set1_pd(extent);
+
+    for (; i + 2 <= count; i += 2) {
+      auto vt = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(values + i), min), range);
+      if constexpr (Inverted) {
+        vt = _mm_sub_pd(one, vt);
+      }
+
+      // operand order matches std::clamp, which passes NaN through
+      vt = _mm_min_pd(one, _mm_max_pd(zero, vt));
+      if constexpr (Flip) {
+        vt = _mm_sub_pd(one, vt);
+      }
+
+      _mm_storeu_pd(
+          projected + i,
+          _mm_add_pd(origin_v, _mm_mul_pd(vt, extent_v)));
+    }
+  }
+#endif
+
+  for (; i < count; ++i) {
+    auto vt = scale(double(values[i]));
+    if constexpr (Inverted) {
+      vt = 1.0 - vt;
+    }
+
+    vt = std::clamp(vt, 0.0, 1.0);
+    if constexpr (Flip) {
+      vt = 1.0 - vt;
+    }
+
+    projected[i] = origin + vt * extent;
+  }
+}
+
+/**
+ * Project the values [begin, count) into `projected`, which must already hold
+ * the projections of the values before `begin`
+ */
+template <typename Scale, typename T>
+void domain_project_continuous(
+    const Scale& scale,
+    bool inverted,
+    const T* values,
+    size_t begin,
+    size_t count,
+    double origin,
+    double extent,
+    bool flip,
+    std::vector<double>* projected) {
+  projected->resize(count);
+  auto kernel = inverted
+      ? (flip
+          ? &domain_project_kernel<Scale, true, true, T>
+          : &domain_project_kernel<Scale, true, false, T>)
+      : (flip
+          ? &domain_project_kernel<Scale, false, true, T>
+          : &domain_project_kernel<Scale, false, false, T>);
+
+  kernel(
+      scale,
+      values + begin,
+      count - begin,
+      origin,
+      extent,
+      projected->data() + begin);
+}
+
+template <typename T>
+void domain_project_continuous(
     const DomainConfig& domain,
-    const Series& series) {
+    const T* values,
+    size_t begin,
+    size_t count,
+    double origin,
+    double extent,
+    bool flip,
+    std::vector<double>* projected) {
+  switch (domain.kind) {
+    case DomainKind::LINEAR:
+      domain_project_continuous(
+          DomainScaleLinear(domain),
+          domain.inverted,
+          values,
+          begin,
+          count,
+          origin,
+          extent,
+          flip,
+          projected);
+      return;
+    case DomainKind::LOGARITHMIC:
+      domain_project_continuous(
+          DomainScaleLog(domain),
+          domain.inverted,
+          values,
+          begin,
+          count,
+          origin,
+          extent,
+          flip,
+          projected);
+      return;
+    default:
+      projected->resize(count, std::numeric_limits<double>::quiet_NaN());
+      return;
+  }
+}
+
+/**
+ * Project the numeric values [begin, series.length) of the series
+ */
+static void domain_project_numeric(
+    const DomainConfig& domain,
+    const Series& series,
+    size_t begin,
+    double origin,
+    double extent,
+    bool flip,
+    std::vector<double>* projected) {
+  if (series.type == SeriesType::FLOAT64) {
+    domain_project_continuous(
+        domain,
+        series_f64(series),
+        begin,
+        series.length,
+        origin,
+        extent,
+        flip,
+        projected);
+  } else {
+    domain_project_continuous(
+        domain,
+        series.i64.data(),
+        begin,
+        series.length,
+        origin,
+        extent,
+        flip,
+        projected);
+  }
+}
+
+/**
+ * Project a growing series, reusing the coordinates of an earlier projection
+ * with the same domain and screen range. Only the values that were appended
+ * since then are projected; if the domain changed, e.g. because it is fitted
+ * automatically and the new values extend it, all values are projected again
+ */
+static std::vector<double> domain_project_cached(
+    const DomainConfig& domain,
+    const Series& series,
+    double origin,
+    double extent,
+    bool flip) {
+  std::vector<double> params = {
+    double(domain.kind),
+    double(domain.inverted),
+    domain_min(domain),
+    domain_max(domain),
+    domain.log_base.value_or(kDefaultLogBase),
+    origin,
+    extent,
+    double(flip),
+  };
+
+  auto& cache = series.projections;
+  auto entry = std::find_if(cache.begin(), cache.end(), [&params] (const auto& e) {
+    return e.params == params;
+  });
+
+  if (entry == cache.end()) {
+    if (cache.size() >= kSeriesProjectionCacheSize) {
+      cache.erase(cache.begin());
+    }
+
+    cache.emplace_back();
+    entry = std::prev(cache.end());
+    entry->params = std::move(params);
+  }
+
+  auto& projected = entry->values;
+  if (projected.size() > series.length) {
+    projected.clear();
+  }
+
+  domain_project_numeric(
+      domain,
+      series,
+      projected.size(),
+      origin,
+      extent,
+      flip,
+      &projected);
+
+  return projected;
+}
+
+double domain_project_value(
+    double vt,
+    double origin,
+    double extent,
+    bool flip) {
+  return origin + (flip ? 1.0 - vt : vt) * extent;
+}
+
+std::vector<double> domain_project_categorical(
+    const DomainConfig& domain,
+    const Series& series,
+    double origin,
+    double extent,
+    bool flip) {
+  const auto& dict = series_dictionary(series);
+
+  std::vector<double> lookup;
+  lookup.reserve(dict.dict.size());
+  for (const auto& v : dict.dict) {
+    lookup.push_back(
+        domain_project_value(
+            domain_translate_categorical(domain, v),
+            origin,
+            extent,
+            flip));
+  }
+
+  std::vector<double> values(series.length);
+  for (size_t i = 0; i < series.length; ++i) {
+    values[i] = lookup[dict.codes[i]];
+  }
+
+  return values;
+}
+
+std::vector<double> domain_project(
+    const DomainConfig& domain,
+    const Series& series,
+    double origin,
+    double extent,
+    bool flip) {
+  if (domain.kind == DomainKind::CATEGORICAL) {
+    return domain_project_categorical(domain, series, origin, extent, flip);
+  }
+
+  if (series_is_numeric(series)) {
+    if (series.cache_projections) {
+      return domain_project_cached(domain, series, origin, extent, flip);
+    }
+
+    std::vector<double> projected;
+    domain_project_numeric(domain, series, 0, origin, extent, flip, &projected);
+    return projected;
+  }
+
   std::vector<double> values;
-  for (const auto& v : series) {
-    values.push_back(domain_translate(domain, v));
+  values.reserve(series.length);
+
+  for (const auto& v : series.text) {
+    values.push_back(
+        domain_project_value(
+            domain_translate(domain, v),
+            origin,
+            extent,
+            flip));
   }
 
   return values;
 }
 
+std::vector<double> domain_translate(
+    const DomainConfig& domain,
+    const Series& series) {
+  return domain_project(domain, series, 0.0, 1.0, false);
+}
+
 Value domain_untranslate_linear(const DomainConfig& domain, double vt) {
   auto min = domain_min(domain);
   auto max = domain_max(domain);
@@ -262,10 +588,10 @@ Value domain_untranslate(
   return {};
 }
 
-Series domain_untranslate(
+std::vector<Value> domain_untranslate(
     const DomainConfig& domain,
     const std::vector<double>& values) {
-  Series s;
+  std::vector<Value> s;
   for (const auto& v : values) {
     s.emplace_back(domain_untranslate(domain, v));
   }
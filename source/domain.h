@@ -80,11 +80,23 @@ std::vector<double> domain_translate(
     const DomainConfig& domain,
     const Series& series);
 
+/**
+ * Translate a series and map the result onto a screen axis in one pass. Each
+ * value ends up at origin + t * extent where t is the translated value (or
+ * 1 - t if flip is set, for axes that grow downwards on screen)
+ */
+std::vector<double> domain_project(
+    const DomainConfig& domain,
+    const Series& series,
+    double origin,
+    double extent,
+    bool flip);
+
 Value domain_untranslate(
     const DomainConfig& domain,
     double data);
 
-Series domain_untranslate(
+std::vector<Value> domain_untranslate(
     const DomainConfig& domain,
     const std::vector<double>& data);
 
@@ -45,6 +45,8 @@ using plist::PropertyList;
 
 using ElementDrawFn = std::function<ReturnCode (const Rectangle&, Layer*)>;
 
+using ElementUpdateFn = std::function<ReturnCode ()>;
+
 template <typename T>
 using ElementDrawAsFn = std::function<ReturnCode (const T&, const Rectangle&, Layer*)>;
 
@@ -55,8 +57,17 @@ using ElementConfigureAsFn = std::function<ReturnCode (
     const Document&,
     T*)>;
 
+template <typename T>
+using ElementUpdateAsFn = std::function<ReturnCode (T*)>;
+
+/**
+ * A configured element. `update` is optional: it extends the element after
+ * the series it references grew in place (see `plotfx_append_f64v`). Elements
+ * without it, or whose update fails, have to be configured again.
+ */
 struct Element {
   ElementDrawFn draw;
+  ElementUpdateFn update;
 };
 
 using ElementRef = std::shared_ptr<Element>;
@@ -36,7 +36,10 @@ namespace plotfx {
 using ElementConfigureFn = std::function<ReturnCode (const Document&, const PropertyList&, ElementRef*)>;
 
 static std::unordered_map<std::string, ElementBuilder> elems = {
-  {"plot", elem_builder<plot::PlotConfig>(&plot::configure, &plot::draw)},
+  {
+    "plot",
+    elem_builder<plot::PlotConfig>(&plot::configure, &plot::draw, &plot::update)
+  },
 };
 
 ReturnCode buildElement(
@@ -43,7 +43,8 @@ using ElementBuilder = std::function<ReturnCode (
 template <typename T>
 ElementBuilder elem_builder(
     ElementConfigureAsFn<T> config_fn,
-    ElementDrawAsFn<T> draw_fn);
+    ElementDrawAsFn<T> draw_fn,
+    ElementUpdateAsFn<T> update_fn = nullptr);
 
 ReturnCode buildElement(
     const std::string& name,
@@ -34,22 +34,32 @@ namespace plotfx {
 template <typename T>
 ElementBuilder elem_builder(
     ElementConfigureAsFn<T> config_fn,
-    ElementDrawAsFn<T> draw_fn) {
-  using namespace std::placeholders;
-
+    ElementDrawAsFn<T> draw_fn,
+    ElementUpdateAsFn<T> update_fn) {
   return [=] (
       const plist::PropertyList& prop,
       const DataContext& data,
       const Document& doc,
       ElementRef* elem) -> ReturnCode {
 
-    T config;
-    if (auto rc = config_fn(prop, data, doc, &config); !rc) {
+    // the config is shared by draw and update, so that updates are visible to
+    // the next draw
+    auto config = std::make_shared<T>();
+    if (auto rc = config_fn(prop, data, doc, config.get()); !rc) {
       return rc;
     }
 
     auto e = std::make_unique<Element>();
-    e->draw = bind(draw_fn, config, _1, _2);
+    e->draw = [draw_fn, config] (const Rectangle& clip, Layer* layer) {
+      return draw_fn(*config, clip, layer);
+    };
+
+    if (update_fn) {
+      e->update = [update_fn, config] {
+        return update_fn(config.get());
+      };
+    }
+
     *elem = std::move(e);
     return OK;
   };
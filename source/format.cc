@@ -27,19 +27,48 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-#include <sstream>
-#include <iomanip>
+#include <charconv>
 #include "format.h"
 #include "source/config_helpers.h"
 #include "source/utils/UnixTime.h"
 
 namespace plotfx {
 
+static std::string format_float(
+    double v,
+    std::chars_format fmt,
+    size_t precision) {
+  char buf[128];
+  auto res = std::to_chars(buf, buf + sizeof(buf), v, fmt, precision);
+  if (res.ec == std::errc()) {
+    return std::string(buf, res.ptr);
+  }
+
+  /* fixed notation of large values or with a large precision */
+  std::string str(512 + precision, 0);
+  res = std::to_chars(str.data(), str.data() + str.size(), v, fmt, precision);
+  str.resize(res.ptr - str.data());
+  return str;
+}
+
+static ReturnCode parse_precision(
+    const plist::Property& prop,
+    uint32_t* precision) {
+  double value;
+  if (!value_parse_float(prop.value, &value) || value < 0) {
+    return ERROR;
+  }
+
+  *precision = value;
+  return OK;
+}
+
 Formatter format_decimal_scientific(size_t precision) {
   return [precision] (const Value& v) -> std::string {
-    std::stringstream s;
-    s << std::scientific << std::setprecision(precision) << value_to_float(v);
-    return s.str();
+    return format_float(
+        value_to_float(v),
+        std::chars_format::scientific,
+        precision);
   };
 }
 
@@ -51,12 +80,10 @@ ReturnCode confgure_format_decimal_scientific(
     case 0:
       break;
     case 1:
-      try {
-        precision = std::stod(prop[0]);
-        break;
-      } catch (... ) {
-        return ERROR;
+      if (auto rc = parse_precision(prop[0], &precision); !rc) {
+        return rc;
       }
+      break;
     default:
       return ERROR;
   }
@@ -67,9 +94,10 @@ ReturnCode confgure_format_decimal_scientific(
 
 Formatter format_decimal_fixed(size_t precision) {
   return [precision] (const Value& v) -> std::string {
-    std::stringstream s;
-    s << std::fixed << std::setprecision(precision) << value_to_float(v);
-    return s.str();
+    return format_float(
+        value_to_float(v),
+        std::chars_format::fixed,
+        precision);
   };
 }
 
@@ -85,12 +113,10 @@ ReturnCode confgure_format_decimal_fixed(
     case 0:
       break;
     case 1:
-      try {
-        precision = std::stod(prop[0]);
-        break;
-      } catch (... ) {
-        return ERROR;
+      if (auto rc = parse_precision(prop[0], &precision); !rc) {
+        return rc;
       }
+      break;
     default:
       return ERROR;
   }
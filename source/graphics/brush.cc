@@ -40,8 +40,7 @@ void fillPath(
   fillPath(
       layer,
       Rectangle(0, 0, layer->width, layer->height),
-      path.data(),
-      path.size(),
+      path,
       style);
 }
 
@@ -58,13 +57,44 @@ void fillPath(
   layer->apply(op);
 }
 
-void fillPath(
+void fillPaths(
     Layer* layer,
     const Rectangle& clip,
-    const PathData* point_data,
-    size_t point_count,
+    const Path& path,
+    const std::vector<size_t>& shapes,
     const FillStyle& style) {
-  return fillPath(layer, clip, Path(point_data, point_count), style);
+  layer_ops::BrushFillBatchOp op;
+  op.clip = clip;
+  op.path = path;
+  op.shapes = shapes;
+  op.style = style;
+  layer->apply(op);
+}
+
+FillBatch::FillBatch(
+    Layer* layer,
+    const Rectangle& clip) :
+    layer_(layer),
+    clip_(clip) {}
+
+Path& FillBatch::add(const FillStyle& style) {
+  if (!shapes_.empty() && style.color != style_.color) {
+    flush();
+  }
+
+  style_ = style;
+  shapes_.push_back(path_.size());
+  return path_;
+}
+
+void FillBatch::flush() {
+  if (shapes_.empty()) {
+    return;
+  }
+
+  fillPaths(layer_, clip_, path_, shapes_, style_);
+  path_ = Path();
+  shapes_.clear();
 }
 
 void strokePath(
@@ -74,8 +104,7 @@ void strokePath(
   strokePath(
       layer,
       Rectangle(0, 0, layer->width, layer->height),
-      path.data(),
-      path.size(),
+      path,
       style);
 }
 
@@ -91,15 +120,6 @@ void strokePath(
   layer->apply(op);
 }
 
-void strokePath(
-    Layer* layer,
-    const Rectangle& clip,
-    const PathData* point_data,
-    size_t point_count,
-    const StrokeStyle& style) {
-  strokePath(layer, clip, Path(point_data, point_count), style);
-}
-
 void strokeLine(
     Layer* layer,
     const Point& p1,
@@ -31,6 +31,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <vector>
 #include "color.h"
 #include "path.h"
 #include "measure.h"
@@ -72,29 +73,52 @@ void fillPath(
     const Path& path,
     const FillStyle& style);
 
-void fillPath(
+void fillPaths(
     Layer* layer,
     const Rectangle& clip,
-    const PathData* path_data,
-    size_t path_data_count,
+    const Path& path,
+    const std::vector<size_t>& shapes,
     const FillStyle& style);
 
-void strokePath(
-    Layer* layer,
-    const Path& path,
-    const StrokeStyle& style);
+/**
+ * Collects consecutive shapes that share a fill style and submits each run
+ * of them as a single batch operation. The drawing order is preserved, so
+ * using a FillBatch gives the same result as calling fillPath for every shape
+ */
+class FillBatch {
+public:
+
+  FillBatch(Layer* layer, const Rectangle& clip);
+  FillBatch(const FillBatch&) = delete;
+  FillBatch& operator=(const FillBatch&) = delete;
+
+  /**
+   * Start a new shape and return the path to which it should be appended
+   */
+  Path& add(const FillStyle& style);
+
+  /**
+   * Submit all pending shapes to the layer
+   */
+  void flush();
+
+protected:
+  Layer* layer_;
+  Rectangle clip_;
+  Path path_;
+  std::vector<size_t> shapes_;
+  FillStyle style_;
+};
 
 void strokePath(
     Layer* layer,
-    const Rectangle& clip,
     const Path& path,
     const StrokeStyle& style);
 
 void strokePath(
     Layer* layer,
     const Rectangle& clip,
-    const PathData* path_data,
-    size_t path_data_count,
+    const Path& path,
     const StrokeStyle& style);
 
 void strokeLine(
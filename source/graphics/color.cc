@@ -155,6 +155,20 @@ std::string Color::to_hex_str() const {
   return ss.str();
 }
 
+bool operator==(const Color& a, const Color& b) {
+  for (size_t i = 0; i < Color::kMaxComponents; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool operator!=(const Color& a, const Color& b) {
+  return !(a == b);
+}
+
 std::ostream& operator <<(std::ostream& os, const Color& c) {
   os << "Color(";
   os << c[0];
@@ -67,6 +67,9 @@ protected:
   double components_[kMaxComponents];
 };
 
+bool operator==(const Color& a, const Color& b);
+bool operator!=(const Color& a, const Color& b);
+
 std::ostream& operator <<(std::ostream& os, const Color& c);
 
 } // namespace plotfx
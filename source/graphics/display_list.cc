@@ -0,0 +1,365 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <type_traits>
+#include "display_list.h"
+
+namespace plotfx {
+
+enum class DisplayOp : uint8_t {
+  BRUSH_FILL,
+  BRUSH_FILL_BATCH,
+  BRUSH_STROKE,
+  TEXT_SPAN
+};
+
+DisplayList::DisplayList() :
+    width(0),
+    height(0),
+    dpi(0),
+    op_count(0) {}
+
+static size_t align_offset(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+static void put(std::vector<char>* data, const T& value) {
+  static_assert(std::is_trivially_copyable<T>::value, "not a POD type");
+  auto offset = data->size();
+  data->resize(offset + sizeof(T));
+  memcpy(data->data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+static void put_array(std::vector<char>* data, const T* values, size_t count) {
+  static_assert(std::is_trivially_copyable<T>::value, "not a POD type");
+  put(data, count);
+
+  /* arrays are aligned (relative to the start of the buffer) so that they
+     can be read in place */
+  auto offset = align_offset(data->size(), alignof(T));
+  data->resize(offset + count * sizeof(T));
+  memcpy(data->data() + offset, values, count * sizeof(T));
+}
+
+static void put_string(std::vector<char>* data, const std::string& str) {
+  put_array(data, str.data(), str.size());
+}
+
+static void put_path(std::vector<char>* data, const Path& path) {
+  put_array(data, path.commands(), path.size());
+  put_array(data, path.coefficients(), path.coefficientCount());
+}
+
+/* reads values back in the order in which they were written */
+struct DisplayListReader {
+  const char* begin;
+  const char* cur;
+  const char* end;
+  double scale;
+
+  template <typename T>
+  bool get(T* value) {
+    if (size_t(end - cur) < sizeof(T)) {
+      return false;
+    }
+
+    memcpy(value, cur, sizeof(T));
+    cur += sizeof(T);
+    return true;
+  }
+
+  template <typename T>
+  bool get_array(const T** values, size_t* count) {
+    if (!get(count)) {
+      return false;
+    }
+
+    auto offset = align_offset(cur - begin, alignof(T));
+    if (offset > size_t(end - begin) ||
+        (size_t(end - begin) - offset) / sizeof(T) < *count) {
+      return false;
+    }
+
+    cur = begin + offset;
+    *values = reinterpret_cast<const T*>(cur);
+    cur += *count * sizeof(T);
+    return true;
+  }
+
+  bool get_string(std::string* str) {
+    const char* chars;
+    size_t count;
+    if (!get_array(&chars, &count)) {
+      return false;
+    }
+
+    str->assign(chars, count);
+    return true;
+  }
+
+  bool get_path(Path* path) {
+    const PathCommand* commands;
+    size_t command_count;
+    const double* coefficients;
+    size_t coefficient_count;
+    if (!get_array(&commands, &command_count) ||
+        !get_array(&coefficients, &coefficient_count)) {
+      return false;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < command_count; ++i) {
+      n += path_command_size(commands[i]);
+    }
+
+    if (n != coefficient_count) {
+      return false;
+    }
+
+    if (scale == 1.0) {
+      *path = Path(commands, command_count, coefficients, coefficient_count);
+      return true;
+    }
+
+    /* scale all coordinates but leave the arc angles alone */
+    std::vector<double> scaled(coefficients, coefficients + coefficient_count);
+    n = 0;
+    for (size_t i = 0; i < command_count; ++i) {
+      auto size = path_command_size(commands[i]);
+      auto coords = commands[i] == PathCommand::ARC_TO ? 3 : size;
+      for (size_t j = 0; j < coords; ++j) {
+        scaled[n + j] *= scale;
+      }
+
+      n += size;
+    }
+
+    *path = Path(commands, command_count, scaled.data(), scaled.size());
+    return true;
+  }
+
+  bool get_measure(Measure* value) {
+    if (!get(value)) {
+      return false;
+    }
+
+    value->value *= scale;
+    return true;
+  }
+
+  bool get_rectangle(Rectangle* value) {
+    if (!get(value)) {
+      return false;
+    }
+
+    value->x *= scale;
+    value->y *= scale;
+    value->w *= scale;
+    value->h *= scale;
+    return true;
+  }
+
+  bool get_point(Point* value) {
+    if (!get(value)) {
+      return false;
+    }
+
+    value->x *= scale;
+    value->y *= scale;
+    return true;
+  }
+};
+
+static Status record_op(DisplayList* list, const layer_ops::Op& op) {
+  auto data = &list->data;
+
+  if (auto o = std::get_if<layer_ops::BrushFillOp>(&op); o) {
+    put(data, DisplayOp::BRUSH_FILL);
+    put(data, o->clip);
+    put(data, o->style);
+    put_path(data, o->path);
+  } else if (auto o = std::get_if<layer_ops::BrushFillBatchOp>(&op); o) {
+    put(data, DisplayOp::BRUSH_FILL_BATCH);
+    put(data, o->clip);
+    put(data, o->style);
+    put_array(data, o->shapes.data(), o->shapes.size());
+    put_path(data, o->path);
+  } else if (auto o = std::get_if<layer_ops::BrushStrokeOp>(&op); o) {
+    put(data, DisplayOp::BRUSH_STROKE);
+    put(data, o->clip);
+    put(data, o->style);
+    put_path(data, o->path);
+  } else if (auto o = std::get_if<layer_ops::TextSpanOp>(&op); o) {
+    put(data, DisplayOp::TEXT_SPAN);
+    put_string(data, o->text);
+    put(data, o->position);
+    put(data, o->style.direction);
+    put_string(data, o->style.font.font_file);
+    put_string(data, o->style.font.font_family_css);
+    put(data, o->style.font.font_metrics);
+    put(data, o->style.font_size);
+    put(data, o->style.color);
+  } else {
+    /* the SubmitOp is not recorded; call layer_submit on the replay target */
+    return OK;
+  }
+
+  ++list->op_count;
+  return OK;
+}
+
+ReturnCode layer_bind_recorder(
+    double width,
+    double height,
+    double dpi,
+    Measure font_size,
+    DisplayList* list,
+    LayerRef* layer) {
+  list->width = width;
+  list->height = height;
+  list->dpi = dpi;
+  list->font_size = font_size;
+
+  layer->reset(new Layer{
+    .width = width,
+    .height = height,
+    .dpi = dpi,
+    .font_size = font_size,
+    .text_shaper = std::make_shared<text::TextShaper>(),
+    .apply = [list] (const auto& op) {
+      return record_op(list, op);
+    },
+  });
+
+  return OK;
+}
+
+static ReturnCode display_list_decode(
+    const DisplayList& list,
+    double scale,
+    std::function<Status (const layer_ops::Op&)> fn) {
+  DisplayListReader reader;
+  reader.begin = list.data.data();
+  reader.cur = list.data.data();
+  reader.end = list.data.data() + list.data.size();
+  reader.scale = scale;
+
+  while (reader.cur != reader.end) {
+    DisplayOp type;
+    if (!reader.get(&type)) {
+      return ReturnCode::error("ERUNTIME", "corrupt display list");
+    }
+
+    bool ok = false;
+    layer_ops::Op op;
+    switch (type) {
+      case DisplayOp::BRUSH_FILL: {
+        layer_ops::BrushFillOp o;
+        ok =
+            reader.get_rectangle(&o.clip) &&
+            reader.get(&o.style) &&
+            reader.get_path(&o.path);
+        op = std::move(o);
+        break;
+      }
+
+      case DisplayOp::BRUSH_FILL_BATCH: {
+        layer_ops::BrushFillBatchOp o;
+        const size_t* shapes;
+        size_t shape_count;
+        ok =
+            reader.get_rectangle(&o.clip) &&
+            reader.get(&o.style) &&
+            reader.get_array(&shapes, &shape_count) &&
+            reader.get_path(&o.path);
+        if (ok) {
+          o.shapes.assign(shapes, shapes + shape_count);
+        }
+
+        op = std::move(o);
+        break;
+      }
+
+      case DisplayOp::BRUSH_STROKE: {
+        layer_ops::BrushStrokeOp o;
+        ok =
+            reader.get_rectangle(&o.clip) &&
+            reader.get(&o.style) &&
+            reader.get_path(&o.path);
+        o.style.line_width.value *= scale;
+        op = std::move(o);
+        break;
+      }
+
+      case DisplayOp::TEXT_SPAN: {
+        layer_ops::TextSpanOp o;
+        ok =
+            reader.get_string(&o.text) &&
+            reader.get_point(&o.position) &&
+            reader.get(&o.style.direction) &&
+            reader.get_string(&o.style.font.font_file) &&
+            reader.get_string(&o.style.font.font_family_css) &&
+            reader.get(&o.style.font.font_metrics) &&
+            reader.get_measure(&o.style.font_size) &&
+            reader.get(&o.style.color);
+        op = std::move(o);
+        break;
+      }
+    }
+
+    if (!ok) {
+      return ReturnCode::error("ERUNTIME", "corrupt display list");
+    }
+
+    if (auto rc = fn(op); rc != OK) {
+      return rc;
+    }
+  }
+
+  return OK;
+}
+
+ReturnCode display_list_visit(
+    const DisplayList& list,
+    std::function<Status (const layer_ops::Op&)> fn) {
+  return display_list_decode(list, 1.0, fn);
+}
+
+ReturnCode display_list_replay(
+    const DisplayList& list,
+    double scale,
+    Layer* layer) {
+  return display_list_decode(list, scale, layer->apply);
+}
+
+} // namespace plotfx
+
@@ -0,0 +1,88 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <functional>
+#include <vector>
+#include "layer.h"
+
+namespace plotfx {
+
+/**
+ * A display list is a recording of all drawing operations that were applied
+ * to a layer. The operations are encoded back to back into a single buffer;
+ * paths and text are stored inline, so recording a document costs a few
+ * large allocations rather than one per operation.
+ *
+ * A display list can be replayed to any other layer (e.g. to render the same
+ * document to SVG and PNG without running layout twice) and inspected or
+ * benchmarked without involving a rendering backend.
+ */
+struct DisplayList {
+  DisplayList();
+  double width;
+  double height;
+  double dpi;
+  Measure font_size;
+  std::vector<char> data;
+  size_t op_count;
+  RenderStats stats;
+};
+
+/**
+ * Create a layer that records all operations into the given display list.
+ * The display list must outlive the layer
+ */
+ReturnCode layer_bind_recorder(
+    double width,
+    double height,
+    double dpi,
+    Measure font_size,
+    DisplayList* list,
+    LayerRef* layer);
+
+/**
+ * Decode the operations in the display list and call `fn` for each of them
+ */
+ReturnCode display_list_visit(
+    const DisplayList& list,
+    std::function<Status (const layer_ops::Op&)> fn);
+
+/**
+ * Apply all recorded operations to the given layer. All coordinates, line
+ * widths and font sizes are multiplied by `scale`, so the layer should be
+ * `scale` times the size of the recorded one
+ */
+ReturnCode display_list_replay(
+    const DisplayList& list,
+    double scale,
+    Layer* layer);
+
+} // namespace plotfx
+
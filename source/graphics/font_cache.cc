@@ -0,0 +1,147 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <harfbuzz/hb-ft.h>
+#include "font_cache.h"
+
+namespace plotfx {
+namespace text {
+
+/* owns the FreeType library; all faces of a cache hold a reference to it */
+struct FontLibrary {
+  FontLibrary() : ft_ready(false) {}
+
+  ~FontLibrary() {
+    if (ft_ready) {
+      FT_Done_FreeType(ft);
+    }
+  }
+
+  FT_Library ft;
+  bool ft_ready;
+};
+
+FontSimpleTable::FontSimpleTable() :
+    glyphs(kFontSimpleCharCount, 0),
+    advances(kFontSimpleCharCount, kFontSimpleUnknown) {}
+
+FontEntry::FontEntry() :
+    ft_face(nullptr),
+    hb_font(nullptr) {}
+
+FontEntry::~FontEntry() {
+  if (hb_font) {
+    hb_font_destroy(hb_font);
+  }
+
+  if (ft_face) {
+    FT_Done_Face(ft_face);
+  }
+}
+
+bool operator==(const FontKey& a, const FontKey& b) {
+  return
+      a.font_size == b.font_size &&
+      a.dpi == b.dpi &&
+      a.font_file == b.font_file;
+}
+
+size_t FontKeyHash::operator()(const FontKey& key) const {
+  size_t h = std::hash<std::string>{}(key.font_file);
+  h = h * 31 + std::hash<double>{}(key.font_size);
+  return h * 31 + std::hash<double>{}(key.dpi);
+}
+
+FontCache::FontCache(size_t capacity) :
+    library_(std::make_shared<FontLibrary>()),
+    entries_(capacity) {}
+
+ReturnCode FontCache::getFont(
+    const std::string& font_file,
+    double font_size,
+    double dpi,
+    FontRef* font) {
+  FontKey key{font_file, font_size, dpi};
+
+  if (auto cached = entries_.get(key); cached) {
+    *font = *cached;
+    return OK;
+  }
+
+  if (!library_->ft_ready) {
+    if (FT_Init_FreeType(&library_->ft)) {
+      return ReturnCode::error("EFONT", "unable to initialize FreeType");
+    }
+
+    library_->ft_ready = true;
+  }
+
+  auto entry = std::make_shared<FontEntry>();
+  entry->library = library_;
+
+  if (FT_New_Face(library_->ft, font_file.c_str(), 0, &entry->ft_face)) {
+    entry->ft_face = nullptr;
+    return ReturnCode::errorf("EFONT", "unable to load font: $0", font_file);
+  }
+
+  auto font_size_ft = font_size * (72.0 / dpi) * 64;
+  if (FT_Set_Char_Size(entry->ft_face, 0, font_size_ft, dpi, dpi)) {
+    return ReturnCode::errorf("EFONT", "invalid font size: $0", font_size);
+  }
+
+  entry->hb_font = hb_ft_font_create_referenced(entry->ft_face);
+
+  entries_.put(std::move(key), entry);
+  *font = std::move(entry);
+  return OK;
+}
+
+void FontCache::setCapacity(size_t capacity) {
+  entries_.setCapacity(capacity);
+}
+
+size_t FontCache::getCapacity() const {
+  return entries_.getCapacity();
+}
+
+size_t FontCache::size() const {
+  return entries_.size();
+}
+
+const CacheStats& FontCache::getStats() const {
+  return entries_.getStats();
+}
+
+void FontCache::clear() {
+  entries_.clear();
+}
+
+} // namespace text
+} // namespace plotfx
+
@@ -0,0 +1,152 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <harfbuzz/hb.h>
+
+#include "utils/lru_cache.h"
+#include "utils/return_code.h"
+
+namespace plotfx {
+namespace text {
+
+/**
+ * Default number of (font file, size, dpi) combinations kept in a font cache
+ */
+static const size_t kFontCacheDefaultCapacity = 32;
+
+struct FontLibrary;
+
+/**
+ * Number of characters covered by the simple shaping table of a font: the
+ * printable ASCII characters (U+0020 to U+007E) followed by the Latin-1
+ * supplement (U+00A0 to U+00FF)
+ */
+static const size_t kFontSimpleCharCount = 0x5f + 0x60;
+
+/**
+ * Marks table entries that were not computed yet and entries of characters
+ * or pairs that can not be shaped without HarfBuzz
+ */
+static const int16_t kFontSimpleUnknown = INT16_MIN;
+static const int16_t kFontSimpleComplex = INT16_MIN + 1;
+
+/**
+ * Glyph ids and advances of the characters in the simple shaping table and
+ * the adjustment (kerning) of each pair of them, in 26.6 pixels. The entries
+ * are filled in lazily by the text shaper the first time a character or a
+ * pair is used
+ */
+struct FontSimpleTable {
+  FontSimpleTable();
+  std::vector<uint32_t> glyphs;
+  std::vector<int32_t> advances;
+  std::vector<int16_t> kerning;
+};
+
+/**
+ * A font file that was loaded and set to a specific size. Entries are shared;
+ * an entry that is evicted from the cache stays valid until the last
+ * reference to it is dropped
+ */
+struct FontEntry {
+  FontEntry();
+  ~FontEntry();
+  FontEntry(const FontEntry&) = delete;
+  FontEntry& operator=(const FontEntry&) = delete;
+
+  std::shared_ptr<FontLibrary> library;
+  FT_Face ft_face;
+  hb_font_t* hb_font;
+  mutable FontSimpleTable simple_table;
+};
+
+using FontRef = std::shared_ptr<const FontEntry>;
+
+struct FontKey {
+  std::string font_file;
+  double font_size;
+  double dpi;
+};
+
+bool operator==(const FontKey& a, const FontKey& b);
+
+struct FontKeyHash {
+  size_t operator()(const FontKey& key) const;
+};
+
+/**
+ * A LRU cache of FreeType faces and HarfBuzz fonts keyed by font file, font
+ * size and dpi. The text shaper and the rasterizer look up fonts through the
+ * same cache, so each font file is opened once per size rather than once per
+ * text span.
+ *
+ * FreeType faces must not be used from more than one thread at a time, so a
+ * cache (and all fonts returned by it) must only be used by one thread
+ */
+class FontCache {
+public:
+
+  explicit FontCache(size_t capacity = kFontCacheDefaultCapacity);
+  FontCache(const FontCache&) = delete;
+  FontCache& operator=(const FontCache&) = delete;
+
+  ReturnCode getFont(
+      const std::string& font_file,
+      double font_size,
+      double dpi,
+      FontRef* font);
+
+  /**
+   * Set the maximum number of entries. Least recently used entries are
+   * evicted if the cache holds more entries than that
+   */
+  void setCapacity(size_t capacity);
+  size_t getCapacity() const;
+
+  size_t size() const;
+  const CacheStats& getStats() const;
+
+  void clear();
+
+protected:
+  std::shared_ptr<FontLibrary> library_;
+  LRUCache<FontKey, FontRef, FontKeyHash> entries_;
+};
+
+} // namespace text
+} // namespace plotfx
+
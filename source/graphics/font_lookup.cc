@@ -27,21 +27,234 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 #include <fontconfig/fontconfig.h>
 #include "font_lookup.h"
+#include "font_metrics.h"
 #include "utils/fileutil.h"
+#include "utils/stringutil.h"
 
 namespace plotfx {
 
+static const char kFontCacheFileHeader[] = "plotfx-fontcache-2";
+
+/**
+ * The fontconfig configuration is loaded once per process; the results of all
+ * lookups are memoized and optionally stored in a cache file. The stamp of the
+ * fontconfig configuration is computed when the cache file is loaded and
+ * reused when it is written
+ */
+struct FontLookupState {
+  FontLookupState();
+  std::mutex mutex;
+  FcConfig* fc_config;
+  std::unordered_map<std::string, std::string> memo;
+  std::string cache_file;
+  std::string cache_stamp;
+  bool cache_file_loaded;
+  CacheStats stats;
+};
+
+FontLookupState::FontLookupState() :
+    fc_config(nullptr),
+    cache_file_loaded(false) {}
+
+static FontLookupState* font_lookup_state() {
+  static FontLookupState state;
+  return &state;
+}
+
+static std::string font_file_stamp(const std::string& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return "-";
+  }
+
+  return StringUtil::format("$0:$1", uint64_t(st.st_mtime), uint64_t(st.st_size));
+}
+
+/**
+ * Adds the stamps of a directory and all of its subdirectories to the given
+ * hash. Adding or removing a font file changes the modification time of the
+ * directory that contains it, so the font files themselves are not stamped
+ */
+static void font_dir_stamp(const std::string& path, uint64_t* hash) {
+  auto stamp = font_file_stamp(path) + ",";
+  for (auto c : stamp) {
+    *hash = (*hash ^ uint8_t(c)) * 1099511628211ull;
+  }
+
+  auto dir = opendir(path.c_str());
+  if (!dir) {
+    return;
+  }
+
+  std::vector<std::string> subdirs;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) {
+      continue;
+    }
+
+    auto entry_path = path + "/" + entry->d_name;
+    struct stat st;
+    if (lstat(entry_path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+      subdirs.emplace_back(std::move(entry_path));
+    }
+  }
+
+  closedir(dir);
+
+  /* readdir returns the entries in no particular order */
+  std::sort(subdirs.begin(), subdirs.end());
+  for (const auto& subdir : subdirs) {
+    font_dir_stamp(subdir, hash);
+  }
+}
+
+/**
+ * Returns a string that changes when the fontconfig configuration or one of
+ * the font directories (including their subdirectories) changes
+ */
+static std::string font_config_stamp() {
+  std::vector<std::string> paths = {
+    "/etc/fonts/fonts.conf",
+    "/etc/fonts/conf.d",
+    "/usr/share/fonts",
+    "/usr/local/share/fonts",
+  };
+
+  if (auto fc_file = getenv("FONTCONFIG_FILE"); fc_file) {
+    paths.emplace_back(fc_file);
+  }
+
+  if (auto home = getenv("HOME"); home) {
+    paths.emplace_back(std::string(home) + "/.fonts");
+    paths.emplace_back(std::string(home) + "/.local/share/fonts");
+    paths.emplace_back(std::string(home) + "/.config/fontconfig");
+  }
+
+  if (auto data_home = getenv("XDG_DATA_HOME"); data_home) {
+    paths.emplace_back(std::string(data_home) + "/fonts");
+  }
+
+  uint64_t hash = 14695981039346656037ull;
+  for (const auto& path : paths) {
+    font_dir_stamp(path, &hash);
+  }
+
+  return StringUtil::format("$0", hash);
+}
+
+/* file format: a header line, then one "pattern, file, file stamp" line per
+   lookup, separated by tabs */
+static void font_cache_load(FontLookupState* state) {
+  state->cache_stamp = font_config_stamp();
+
+  std::ifstream file(state->cache_file);
+  std::string line;
+  if (!std::getline(file, line) ||
+      line != std::string(kFontCacheFileHeader) + "\t" + state->cache_stamp) {
+    return;
+  }
+
+  while (std::getline(file, line)) {
+    auto fields = StringUtil::split(line, "\t");
+    if (fields.size() != 3 || font_file_stamp(fields[1]) != fields[2]) {
+      continue;
+    }
+
+    state->memo.emplace(fields[0], fields[1]);
+  }
+}
+
+/* the file is written to a unique temporary file first and then renamed, so
+   that concurrent processes never see or write a partial file */
+static void font_cache_store(FontLookupState* state) {
+  std::string data = std::string(kFontCacheFileHeader) + "\t" + state->cache_stamp + "\n";
+  for (const auto& m : state->memo) {
+    if (m.second.empty()) {
+      continue;
+    }
+
+    data += m.first + "\t" + m.second + "\t" + font_file_stamp(m.second) + "\n";
+  }
+
+  auto tmpfile = state->cache_file + ".XXXXXX";
+  auto fd = mkstemp(tmpfile.data());
+  if (fd < 0) {
+    return;
+  }
+
+  fchmod(fd, 0644);
+
+  bool ok = true;
+  for (size_t pos = 0; ok && pos < data.size(); ) {
+    auto n = write(fd, data.data() + pos, data.size() - pos);
+    ok = n > 0;
+    pos += ok ? n : 0;
+  }
+
+  ok = (close(fd) == 0) && ok;
+  if (!ok || rename(tmpfile.c_str(), state->cache_file.c_str()) != 0) {
+    unlink(tmpfile.c_str());
+  }
+}
+
+void font_lookup_set_cache_file(const std::string& path) {
+  auto state = font_lookup_state();
+  std::lock_guard<std::mutex> lk(state->mutex);
+  state->cache_file = path;
+  state->cache_file_loaded = false;
+  state->memo.clear();
+}
+
+CacheStats font_lookup_get_stats() {
+  auto state = font_lookup_state();
+  std::lock_guard<std::mutex> lk(state->mutex);
+  return state->stats;
+}
 
 bool findFontSystem(
     const std::string& font_pattern,
     std::string* font_file) {
+  auto state = font_lookup_state();
+  std::lock_guard<std::mutex> lk(state->mutex);
+
+  if (!state->cache_file.empty() && !state->cache_file_loaded) {
+    font_cache_load(state);
+    state->cache_file_loaded = true;
+  }
+
+  if (auto m = state->memo.find(font_pattern); m != state->memo.end()) {
+    ++state->stats.hits;
+    if (m->second.empty()) {
+      return false;
+    }
+
+    *font_file = m->second;
+    return true;
+  }
+
+  ++state->stats.misses;
+  if (!state->fc_config) {
+    state->fc_config = FcInitLoadConfigAndFonts();
+  }
+
   std::string file;
 
   {
-    auto fc_config = FcInitLoadConfigAndFonts();
+    auto fc_config = state->fc_config;
     auto fc_pattern = FcNameParse((FcChar8*) font_pattern.c_str());
     FcDefaultSubstitute(fc_pattern);
     FcConfigSubstitute(fc_config, fc_pattern, FcMatchPattern);
@@ -55,50 +268,85 @@ bool findFontSystem(
       FcPatternDestroy(fc_font);
     }
     FcPatternDestroy(fc_pattern);
-    FcConfigDestroy(fc_config);
   }
 
+  state->memo[font_pattern] = file;
+
   if (file.empty()) {
     return false;
   }
 
+  if (!state->cache_file.empty()) {
+    font_cache_store(state);
+  }
+
   *font_file = file;
   return true;
 }
 
 ReturnCode font_load(DefaultFont font_name, FontInfo* font_info) {
+  return font_load(font_name, FontMetricsMode::SYSTEM, font_info);
+}
+
+ReturnCode font_load(
+    DefaultFont font_name,
+    FontMetricsMode mode,
+    FontInfo* font_info) {
   std::string font_css;
-  std::string font_fc;
+  const FontMetrics* font_metrics;
 
   switch (font_name) {
     default:
     case SANS_REGULAR:
     case HELVETICA_REGULAR:
       font_css = "Arial,Helvetica,'Helvetica Neue',sans-serif";
-      font_fc = "Arial,Helvetica,Helvetica Neue:style=Regular,Roman";
+      font_metrics = &kFontMetricsSansRegular;
       break;
 
     case SANS_MEDIUM:
     case HELVETICA_MEDIUM:
       font_css = "Arial,Helvetica,'Helvetica Neue',sans-serif";
-      font_fc = "Arial,Helvetica,Helvetica Neue:style=Medium,Roman";
+      font_metrics = &kFontMetricsSansMedium;
       break;
 
     case SANS_BOLD:
     case HELVETICA_BOLD:
       font_css = "Arial,Helvetica,'Helvetica Neue',sans-serif";
-      font_fc = "Arial,Helvetica,Helvetica Neue:style=Bold,Roman";
+      font_metrics = &kFontMetricsSansBold;
       break;
   }
 
   font_info->font_family_css = font_css;
+  font_info->font_metrics = nullptr;
+
+  if (mode == FontMetricsMode::EMBEDDED) {
+    font_info->font_file.clear();
+    font_info->font_metrics = font_metrics;
+    return OK;
+  }
 
-  if (!findFontSystem(font_fc, &font_info->font_file)) {
+  if (!findFontSystem(font_metrics->font_pattern, &font_info->font_file)) {
     return ERROR;
   }
 
   return OK;
 }
 
+ReturnCode font_get_file(const FontInfo& font_info, std::string* font_file) {
+  if (!font_info.font_file.empty() || !font_info.font_metrics) {
+    *font_file = font_info.font_file;
+    return OK;
+  }
+
+  if (!findFontSystem(font_info.font_metrics->font_pattern, font_file)) {
+    return ReturnCode::errorf(
+        "EARG",
+        "unable to find font: $0",
+        font_info.font_metrics->font_pattern);
+  }
+
+  return OK;
+}
+
 } // namespace plotfx
 
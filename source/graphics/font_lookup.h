@@ -30,13 +30,35 @@
 #pragma once
 #include "plotfx.h"
 #include "text.h"
+#include "utils/lru_cache.h"
 
 namespace plotfx {
 
+/**
+ * Find the font file that fontconfig returns for the given pattern. The
+ * fontconfig configuration is loaded on the first call and the results are
+ * memoized for the lifetime of the process. This function is thread safe
+ */
 bool findFontSystem(
     const std::string& font_pattern,
     std::string* font_file);
 
+/**
+ * Remember the results of `findFontSystem` in the given file, so that later
+ * processes do not have to load the fontconfig configuration. The file is
+ * ignored once the fontconfig configuration or one of the font directories or
+ * their subdirectories changes, and an entry is ignored once its font file
+ * changes. Setting the cache file discards the memoized results, so they are
+ * reloaded from the new file. An empty path disables the cache file
+ */
+void font_lookup_set_cache_file(const std::string& path);
+
+/**
+ * Returns the number of `findFontSystem` calls that were answered from memoized
+ * results or the cache file (hits) and that queried fontconfig (misses)
+ */
+CacheStats font_lookup_get_stats();
+
 enum DefaultFont {
   SANS_REGULAR,
   SANS_MEDIUM,
@@ -46,7 +68,26 @@ enum DefaultFont {
   HELVETICA_BOLD,
 };
 
+enum class FontMetricsMode {
+  SYSTEM,
+  EMBEDDED
+};
+
+/**
+ * Load one of the default fonts. In EMBEDDED mode, the font file is not looked
+ * up; text is measured using compiled-in metrics instead
+ */
 ReturnCode font_load(DefaultFont font_name, FontInfo* font_info);
+ReturnCode font_load(
+    DefaultFont font_name,
+    FontMetricsMode mode,
+    FontInfo* font_info);
+
+/**
+ * Returns the font file of the font, looking it up first if the font was
+ * loaded with embedded metrics
+ */
+ReturnCode font_get_file(const FontInfo& font_info, std::string* font_file);
 
 } // namespace plotfx
 
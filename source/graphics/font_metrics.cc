@@ -0,0 +1,188 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <stdlib.h>
+#include "font_metrics.h"
+
+namespace plotfx {
+
+static const uint16_t kSansRegularAdvances[kFontMetricsCharCount] = {
+     569,  569,  727, 1139, 1139, 1821, 1366,  391,
+     682,  682,  797, 1196,  569,  682,  569,  569,
+    1139, 1139, 1139, 1139, 1139, 1139, 1139, 1139,
+    1139, 1139,  569,  569, 1196, 1196, 1196, 1139,
+    2079, 1366, 1366, 1479, 1479, 1366, 1251, 1593,
+    1479,  569, 1024, 1366, 1139, 1706, 1479, 1593,
+    1366, 1593, 1479, 1366, 1251, 1479, 1366, 1933,
+    1366, 1366, 1251,  569,  569,  569,  961, 1139,
+     682, 1139, 1139, 1024, 1139, 1139,  569, 1139,
+    1139,  455,  455, 1024,  455, 1706, 1139, 1139,
+    1139, 1139,  682, 1024,  569, 1139, 1024, 1479,
+    1024, 1024, 1024,  684,  532,  684, 1196
+};
+
+static const uint16_t kSansBoldAdvances[kFontMetricsCharCount] = {
+     569,  682,  971, 1139, 1139, 1821, 1479,  487,
+     682,  682,  797, 1196,  569,  682,  569,  569,
+    1139, 1139, 1139, 1139, 1139, 1139, 1139, 1139,
+    1139, 1139,  682,  682, 1196, 1196, 1196, 1251,
+    1997, 1479, 1479, 1479, 1479, 1366, 1251, 1593,
+    1479,  569, 1139, 1479, 1251, 1706, 1479, 1593,
+    1366, 1593, 1479, 1366, 1251, 1479, 1366, 1933,
+    1366, 1366, 1251,  682,  569,  682, 1196, 1139,
+     682, 1139, 1251, 1139, 1251, 1139,  682, 1251,
+    1251,  569,  569, 1139,  569, 1821, 1251, 1251,
+    1251, 1251,  797, 1139,  682, 1251, 1139, 1593,
+    1139, 1139, 1024,  797,  573,  797, 1196
+};
+
+/* sorted by (left, right) */
+static const FontMetricsKerningPair kSansRegularKerning[] = {
+  { '1', '1', -152 },
+};
+
+static const FontMetricsKerningPair kSansBoldKerning[] = {
+  { '1', '1', -152 },
+};
+
+const FontMetrics kFontMetricsSansRegular = {
+  "Arial,Helvetica,Helvetica Neue:style=Regular,Roman",
+  2048,
+  1854,
+  -434,
+  kSansRegularAdvances,
+  kSansRegularKerning,
+  sizeof(kSansRegularKerning) / sizeof(FontMetricsKerningPair),
+};
+
+const FontMetrics kFontMetricsSansMedium = {
+  "Arial,Helvetica,Helvetica Neue:style=Medium,Roman",
+  2048,
+  1854,
+  -434,
+  kSansRegularAdvances,
+  kSansRegularKerning,
+  sizeof(kSansRegularKerning) / sizeof(FontMetricsKerningPair),
+};
+
+const FontMetrics kFontMetricsSansBold = {
+  "Arial,Helvetica,Helvetica Neue:style=Bold,Roman",
+  2048,
+  1854,
+  -434,
+  kSansBoldAdvances,
+  kSansBoldKerning,
+  sizeof(kSansBoldKerning) / sizeof(FontMetricsKerningPair),
+};
+
+/* FreeType's rounding fixed-point helpers */
+static int64_t ft_muldiv(int64_t a, int64_t b, int64_t c) {
+  auto v = (std::abs(a * b) + c / 2) / c;
+  return a * b < 0 ? -v : v;
+}
+
+static int64_t ft_pix_floor(int64_t x) {
+  return x & ~int64_t(63);
+}
+
+static int64_t ft_pix_ceil(int64_t x) {
+  return ft_pix_floor(x + 63);
+}
+
+bool font_metrics_shape(
+    const FontMetrics& metrics,
+    const std::string& text,
+    double font_size,
+    double dpi,
+    text::ShapedRun* run) {
+  for (auto c : text) {
+    if (uint8_t(c) < kFontMetricsFirstChar ||
+        uint8_t(c) >= kFontMetricsFirstChar + kFontMetricsCharCount) {
+      return false;
+    }
+  }
+
+  /* compute the scale exactly like FT_Set_Char_Size does, so that the advances
+     are rounded in the same way (hb-ft returns 26.6 advances) */
+  int64_t char_size = font_size * (72.0 / dpi) * 64;
+  int64_t pixel_size = (char_size * int64_t(dpi) + 36) / 72;
+  int64_t scale = ft_muldiv(pixel_size, 0x10000, metrics.units_per_em);
+
+  auto ascender = ft_pix_ceil(ft_muldiv(metrics.ascender, scale, 0x10000));
+  auto descender = ft_pix_floor(ft_muldiv(metrics.descender, scale, 0x10000));
+
+  run->glyphs.clear();
+  run->glyphs.reserve(text.size());
+
+  double line_length = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    auto advance = metrics.advances[uint8_t(text[i]) - kFontMetricsFirstChar];
+    auto advance_26d6 = (ft_muldiv(advance, scale, 64) + 512) >> 10;
+
+    if (i + 1 < text.size()) {
+      auto pair = std::lower_bound(
+          metrics.kerning,
+          metrics.kerning + metrics.kerning_count,
+          std::make_pair(text[i], text[i + 1]),
+          [] (const FontMetricsKerningPair& p, const std::pair<char, char>& k) {
+            return std::make_pair(p.left, p.right) < k;
+          });
+
+      if (pair != metrics.kerning + metrics.kerning_count &&
+          pair->left == text[i] &&
+          pair->right == text[i + 1]) {
+        advance_26d6 += ft_muldiv(pair->value, pixel_size, metrics.units_per_em);
+      }
+    }
+
+    text::GlyphInfo g;
+    g.codepoint = 0;
+    g.advance_x = advance_26d6 / 64.0;
+    g.advance_y = 0;
+    g.metrics_ascender = ascender / 64.0;
+    g.metrics_descender = descender / 64.0;
+    run->glyphs.emplace_back(g);
+
+    line_length += g.advance_x;
+  }
+
+  double top = 0;
+  double bottom = 0;
+  if (!text.empty()) {
+    top = std::min(-ascender / 64.0, top);
+    bottom = std::max(-descender / 64.0, bottom);
+  }
+
+  run->extents = Rectangle(0, top, line_length, bottom - top);
+  return true;
+}
+
+} // namespace plotfx
+
@@ -0,0 +1,97 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <stdint.h>
+#include <string>
+#include "text_shaper.h"
+
+namespace plotfx {
+
+/**
+ * Embedded metrics cover the printable ASCII characters
+ */
+static const uint32_t kFontMetricsFirstChar = 0x20;
+static const uint32_t kFontMetricsCharCount = 0x5f;
+
+/**
+ * The tables only contain the kerning pairs that occur in numbers ("11"), so
+ * numeric and date labels are laid out exactly like the font file. Other
+ * kerned pairs (e.g. "AV" or "P.") are not adjusted, so the width of any other
+ * ASCII label differs from its width when shaped from the font file by at
+ * most this fraction of that width
+ */
+static const double kFontMetricsWidthTolerance = 0.25;
+
+struct FontMetricsKerningPair {
+  char left;
+  char right;
+  int16_t value;
+};
+
+/**
+ * Compiled-in metrics of one of the default fonts, in font units. Text that
+ * consists only of characters covered by the table can be laid out without
+ * loading the font file; the font is only loaded to rasterize glyphs
+ */
+struct FontMetrics {
+  const char* font_pattern;
+  uint16_t units_per_em;
+  int16_t ascender;
+  int16_t descender;
+  const uint16_t* advances;
+  const FontMetricsKerningPair* kerning;
+  size_t kerning_count;
+};
+
+/**
+ * Metrics of Arial, which has the same advance widths as Helvetica. Arial has
+ * no medium weight; the medium font uses the regular metrics
+ */
+extern const FontMetrics kFontMetricsSansRegular;
+extern const FontMetrics kFontMetricsSansMedium;
+extern const FontMetrics kFontMetricsSansBold;
+
+/**
+ * Shape a span of text using embedded metrics. Advances are rounded like
+ * FreeType and HarfBuzz round them for the font file the metrics were taken
+ * from, within the width tolerance above. The glyph ids are not known
+ * without the font file, so the `codepoint` of all glyphs is zero; runs that
+ * are rasterized are shaped again from the font file. Returns false if the
+ * text contains a character that is not in the table
+ */
+bool font_metrics_shape(
+    const FontMetrics& metrics,
+    const std::string& text,
+    double font_size,
+    double dpi,
+    text::ShapedRun* run);
+
+} // namespace plotfx
+
@@ -32,6 +32,10 @@
 
 namespace plotfx {
 
+RenderStats::RenderStats() :
+    marks_drawn(0),
+    marks_culled(0) {}
+
 ReturnCode layer_submit(Layer* layer) {
   return layer->apply(layer_ops::SubmitOp{});
 }
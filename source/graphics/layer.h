@@ -41,6 +41,15 @@
 
 namespace plotfx {
 
+/**
+ * Counters that are collected while drawing to a layer
+ */
+struct RenderStats {
+  RenderStats();
+  size_t marks_drawn;
+  size_t marks_culled;
+};
+
 /**
  * The layer is the central rendering context on which 2D vector graphics
  * operations, such as rendering text and drawing polygons, take place.
@@ -65,6 +74,7 @@ struct Layer {
   Measure font_size;
   const std::shared_ptr<text::TextShaper> text_shaper;
   const std::function<Status (const layer_ops::Op&)> apply;
+  RenderStats stats;
 };
 
 using LayerRef = std::unique_ptr<Layer>;
@@ -56,6 +56,19 @@ struct BrushFillOp {
   FillStyle style;
 };
 
+/**
+ * Fill several shapes with the same style. The shapes are stored back to back
+ * in `path`; `shapes` holds the index of the first command of each shape.
+ * Backends must render the shapes one after another, exactly as if each of
+ * them had been submitted as a separate BrushFillOp
+ */
+struct BrushFillBatchOp {
+  Rectangle clip;
+  Path path;
+  std::vector<size_t> shapes;
+  FillStyle style;
+};
+
 struct TextSpanOp {
   std::string text;
   Point position;
@@ -65,6 +78,7 @@ struct TextSpanOp {
 using Op = std::variant<
     SubmitOp,
     BrushFillOp,
+    BrushFillBatchOp,
     BrushStrokeOp,
     TextSpanOp>;
 
@@ -57,6 +57,8 @@ ReturnCode layer_bind_img(
           return raster->strokePath(op);
         if constexpr (std::is_same_v<T, layer_ops::BrushFillOp>)
           return raster->fillPath(op);
+        if constexpr (std::is_same_v<T, layer_ops::BrushFillBatchOp>)
+          return raster->fillPaths(op);
         if constexpr (std::is_same_v<T, layer_ops::TextSpanOp>)
           return raster->drawText(op);
         if constexpr (std::is_same_v<T, layer_ops::SubmitOp>)
@@ -95,6 +97,8 @@ ReturnCode layer_bind_png(
           return raster->strokePath(op);
         if constexpr (std::is_same_v<T, layer_ops::BrushFillOp>)
           return raster->fillPath(op);
+        if constexpr (std::is_same_v<T, layer_ops::BrushFillBatchOp>)
+          return raster->fillPaths(op);
         if constexpr (std::is_same_v<T, layer_ops::TextSpanOp>)
           return raster->drawText(op);
         if constexpr (std::is_same_v<T, layer_ops::SubmitOp>)
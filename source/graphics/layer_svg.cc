@@ -110,9 +110,10 @@ Status svg_text_span(
   return OK;
 }
 
-std::string svg_path_data(const Path& path) {
+std::string svg_path_data(Path::const_iterator begin, Path::const_iterator end) {
   std::stringstream path_data;
-  for (const auto& cmd : path) {
+  for (auto iter = begin; iter != end; ++iter) {
+    const auto cmd = *iter;
     switch (cmd.command) {
       case PathCommand::MOVE_TO:
         path_data << StringUtil::format("M$0 $1 ", cmd[0], cmd[1]);
@@ -134,6 +135,10 @@ std::string svg_path_data(const Path& path) {
   return path_data.str();
 }
 
+std::string svg_path_data(const Path& path) {
+  return svg_path_data(path.begin(), path.end());
+}
+
 Status svg_stroke_path(
     const layer_ops::BrushStrokeOp& op,
     SVGDataRef svg) {
@@ -172,6 +177,32 @@ Status svg_fill_path(
   return OK;
 }
 
+Status svg_fill_paths(
+    const layer_ops::BrushFillBatchOp& op,
+    SVGDataRef svg) {
+  const auto& path = op.path;
+  const auto& style = op.style;
+  const auto fill = svg_attr("fill", style.color.to_hex_str());
+
+  auto end = path.begin();
+  for (size_t i = 0; i < op.shapes.size(); ++i) {
+    auto begin = end;
+    end = i + 1 < op.shapes.size()
+        ? std::next(begin, op.shapes[i + 1] - op.shapes[i])
+        : path.end();
+
+    svg->buffer
+        << "  "
+        << "<path"
+        << fill
+        << svg_attr("d", svg_path_data(begin, end))
+        << "/>"
+        << "\n";
+  }
+
+  return OK;
+}
+
 std::string SVGData::to_svg() const {
   std::stringstream svg;
   svg
@@ -220,6 +251,8 @@ ReturnCode layer_bind_svg(
           return svg_stroke_path(op, svg);
         if constexpr (std::is_same_v<T, layer_ops::BrushFillOp>)
           return svg_fill_path(op, svg);
+        if constexpr (std::is_same_v<T, layer_ops::BrushFillBatchOp>)
+          return svg_fill_paths(op, svg);
         if constexpr (std::is_same_v<T, layer_ops::TextSpanOp>)
           return svg_text_span(op, svg);
         if constexpr (std::is_same_v<T, layer_ops::SubmitOp>)
@@ -32,113 +32,131 @@
 
 namespace plotfx {
 
+size_t path_command_size(PathCommand command) {
+  switch (command) {
+    case PathCommand::MOVE_TO:
+    case PathCommand::LINE_TO:
+      return 2;
+    case PathCommand::QUADRATIC_CURVE_TO:
+      return 4;
+    case PathCommand::CUBIC_CURVE_TO:
+      return 6;
+    case PathCommand::ARC_TO:
+      return 5;
+    case PathCommand::CLOSE:
+      return 0;
+  }
+
+  return 0;
+}
+
 double PathData::operator[](size_t idx) const {
   return coefficients[idx];
 }
 
-Path::Path() {}
+Path::const_iterator::const_iterator(
+    const PathCommand* command,
+    const double* coefficients) :
+    command_(command),
+    coefficients_(coefficients) {}
 
-Path::Path(const PathData* data, size_t size) {
-  data_.reserve(size);
+PathData Path::const_iterator::operator*() const {
+  return PathData{*command_, coefficients_};
+}
 
-  for (size_t i = 0; i < size; ++i) {
-    data_.emplace_back(data[i]);
-  }
+Path::const_iterator& Path::const_iterator::operator++() {
+  coefficients_ += path_command_size(*command_);
+  ++command_;
+  return *this;
+}
+
+Path::const_iterator Path::const_iterator::operator++(int) {
+  auto iter = *this;
+  ++*this;
+  return iter;
+}
+
+bool Path::const_iterator::operator==(const const_iterator& other) const {
+  return command_ == other.command_;
 }
 
+bool Path::const_iterator::operator!=(const const_iterator& other) const {
+  return command_ != other.command_;
+}
+
+Path::Path() {}
+
+Path::Path(
+    const PathCommand* commands,
+    size_t command_count,
+    const double* coefficients,
+    size_t coefficient_count) :
+    commands_(commands, commands + command_count),
+    coefficients_(coefficients, coefficients + coefficient_count) {}
+
 void Path::moveTo(double x, double y) {
-  PathData d;
-  d.command = PathCommand::MOVE_TO;
-  d.coefficients[0] = x;
-  d.coefficients[1] = y;
-  data_.emplace_back(std::move(d));
+  commands_.emplace_back(PathCommand::MOVE_TO);
+  coefficients_.insert(coefficients_.end(), { x, y });
 }
 
 void Path::lineTo(double x, double y) {
-  PathData d;
-  d.command = PathCommand::LINE_TO;
-  d.coefficients[0] = x;
-  d.coefficients[1] = y;
-  data_.emplace_back(std::move(d));
+  commands_.emplace_back(PathCommand::LINE_TO);
+  coefficients_.insert(coefficients_.end(), { x, y });
 }
 
 void Path::quadraticCurveTo(double cx, double cy, double x, double y) {
-  PathData d;
-  d.command = PathCommand::QUADRATIC_CURVE_TO;
-  d.coefficients[0] = cx;
-  d.coefficients[1] = cy;
-  d.coefficients[2] = x;
-  d.coefficients[3] = y;
-  data_.emplace_back(std::move(d));
+  commands_.emplace_back(PathCommand::QUADRATIC_CURVE_TO);
+  coefficients_.insert(coefficients_.end(), { cx, cy, x, y });
 }
 
 void Path::cubicCurveTo(double c1x, double c1y, double c2x, double c2y, double x, double y) {
-  PathData d;
-  d.command = PathCommand::CUBIC_CURVE_TO;
-  d.coefficients[0] = c1x;
-  d.coefficients[1] = c1y;
-  d.coefficients[2] = c2x;
-  d.coefficients[3] = c2y;
-  d.coefficients[4] = x;
-  d.coefficients[5] = y;
-  data_.emplace_back(std::move(d));
+  commands_.emplace_back(PathCommand::CUBIC_CURVE_TO);
+  coefficients_.insert(coefficients_.end(), { c1x, c1y, c2x, c2y, x, y });
 }
 
 void Path::arcTo(double cx, double cy, double r, double a1, double a2) {
-  PathData d;
-  d.command = PathCommand::ARC_TO;
-  d.coefficients[0] = cx;
-  d.coefficients[1] = cy;
-  d.coefficients[2] = r;
-  d.coefficients[3] = a1;
-  d.coefficients[4] = a2;
-  data_.emplace_back(std::move(d));
+  commands_.emplace_back(PathCommand::ARC_TO);
+  coefficients_.insert(coefficients_.end(), { cx, cy, r, a1, a2 });
 }
 
 void Path::closePath() {
-  PathData d;
-  d.command = PathCommand::CLOSE;
-  data_.emplace_back(std::move(d));
+  commands_.emplace_back(PathCommand::CLOSE);
 }
 
-const PathData& Path::operator[](size_t idx) const {
-  return data_[idx];
+void Path::reserve(size_t size) {
+  commands_.reserve(size);
+  coefficients_.reserve(size * 2);
 }
 
-PathData& Path::operator[](size_t idx) {
-  return data_[idx];
+Path::const_iterator Path::begin() const {
+  return const_iterator(commands_.data(), coefficients_.data());
 }
 
-const PathData* Path::data() const {
-  return &*data_.data();
+Path::const_iterator Path::end() const {
+  return const_iterator(
+      commands_.data() + commands_.size(),
+      coefficients_.data() + coefficients_.size());
 }
 
-PathData* Path::data() {
-  return &*data_.data();
+const PathCommand* Path::commands() const {
+  return commands_.data();
 }
 
-const PathData* Path::begin() const {
-  return &*data_.begin();
+const double* Path::coefficients() const {
+  return coefficients_.data();
 }
 
-PathData* Path::begin() {
-  return &*data_.begin();
-}
-
-const PathData* Path::end() const {
-  return &*data_.end();
-}
-
-PathData* Path::end() {
-  return &*data_.end();
+size_t Path::coefficientCount() const {
+  return coefficients_.size();
 }
 
 size_t Path::size() const {
-  return data_.size();
+  return commands_.size();
 }
 
 bool Path::empty() const {
-  return data_.size() == 0;
+  return commands_.empty();
 }
 
 } // namespace plotfx
+
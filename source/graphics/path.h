@@ -31,11 +31,12 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <iterator>
 #include <vector>
 
 namespace plotfx {
 
-enum class PathCommand {
+enum class PathCommand : uint8_t {
   MOVE_TO,
   LINE_TO,
   QUADRATIC_CURVE_TO,
@@ -46,17 +47,57 @@ enum class PathCommand {
 
 const size_t kPathMaxCoefficients = 6;
 
+/**
+ * Returns the number of coefficients that are stored for a command
+ */
+size_t path_command_size(PathCommand command);
+
+/**
+ * A single command of a path together with a pointer to its coefficients.
+ * Only valid as long as the path it was read from is not modified
+ */
 struct PathData {
   PathCommand command;
-  double coefficients[kPathMaxCoefficients];
+  const double* coefficients;
   double operator[](size_t idx) const;
 };
 
+/**
+ * A path is stored as a stream of one-byte commands and a separate, tightly
+ * packed array of coefficients: a MOVE_TO or LINE_TO takes two doubles, an
+ * ARC_TO five and a CLOSE none. The commands are read back with an iterator
+ * that yields a PathData view for each command.
+ */
 struct Path {
 public:
 
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = PathData;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const PathData*;
+    using reference = PathData;
+
+    const_iterator(const PathCommand* command, const double* coefficients);
+
+    PathData operator*() const;
+    const_iterator& operator++();
+    const_iterator operator++(int);
+    bool operator==(const const_iterator& other) const;
+    bool operator!=(const const_iterator& other) const;
+
+  protected:
+    const PathCommand* command_;
+    const double* coefficients_;
+  };
+
   Path();
-  Path(const PathData* data, size_t size);
+  Path(
+      const PathCommand* commands,
+      size_t command_count,
+      const double* coefficients,
+      size_t coefficient_count);
 
   void moveTo(double x, double y);
   void lineTo(double x, double y);
@@ -65,20 +106,28 @@ public:
   void arcTo(double cx, double cy, double r, double a1, double a2);
   void closePath();
 
-  const PathData& operator[](size_t idx) const;
-  PathData& operator[](size_t idx);
+  /**
+   * Reserve space for `size` commands with two coefficients each (i.e. a
+   * polyline with `size` vertices)
+   */
+  void reserve(size_t size);
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  const PathCommand* commands() const;
+  const double* coefficients() const;
+  size_t coefficientCount() const;
 
-  const PathData* data() const;
-  PathData* data();
-  const PathData* begin() const;
-  PathData* begin();
-  const PathData* end() const;
-  PathData* end();
+  /**
+   * Returns the number of commands in the path
+   */
   size_t size() const;
   bool empty() const;
 
 protected:
-  std::vector<PathData> data_;
+  std::vector<PathCommand> commands_;
+  std::vector<double> coefficients_;
 };
 
 } // namespace plotfx
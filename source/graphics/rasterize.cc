@@ -28,12 +28,146 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <iostream>
+#include <math.h>
+#include <string.h>
 #include <graphics/rasterize.h>
+#include <graphics/font_lookup.h>
 #include <graphics/image.h>
 #include <graphics/text_layout.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace plotfx {
 
+static void rasterize_path(
+    cairo_t* cr_ctx,
+    Path::const_iterator begin,
+    Path::const_iterator end) {
+  for (auto iter = begin; iter != end; ++iter) {
+    const auto cmd = *iter;
+    switch (cmd.command) {
+      case PathCommand::MOVE_TO:
+        cairo_move_to(cr_ctx, cmd[0], cmd[1]);
+        break;
+      case PathCommand::LINE_TO:
+        cairo_line_to(cr_ctx, cmd[0], cmd[1]);
+        break;
+      case PathCommand::ARC_TO:
+        cairo_arc(cr_ctx, cmd[0], cmd[1], cmd[2], cmd[3], cmd[4]);
+        break;
+      default:
+        break; // not yet implemented
+    }
+  }
+}
+
+/* x / 255, rounded, for x <= 255 * 255 */
+static inline uint32_t div255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+/**
+ * Composite a row of premultiplied ARGB32 pixels onto the destination using
+ * the OVER operator: dst = src + dst * (1 - src_alpha)
+ */
+static void blend_over_row(const uint32_t* src, uint32_t* dst, size_t count) {
+  size_t i = 0;
+
+#ifdef __SSE2__
+  const auto zero = _mm_setzero_si128();
+  const auto alpha_max = _mm_set1_epi32(255);
+  const auto round = _mm_set1_epi16(128);
+
+  for (; i + 4 <= count; i += 4) {
+    auto s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff) {
+      continue;
+    }
+
+    auto d = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i));
+
+    /* 255 - alpha, broadcast to the four 16-bit channels of each pixel */
+    auto inv = _mm_sub_epi32(alpha_max, _mm_srli_epi32(s, 24));
+    inv = _mm_or_si128(inv, _mm_slli_epi32(inv, 16));
+    auto inv_lo = _mm_unpacklo_epi32(inv, inv);
+    auto inv_hi = _mm_unpackhi_epi32(inv, inv);
+
+    auto d_lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv_lo);
+    auto d_hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv_hi);
+    d_lo = _mm_add_epi16(d_lo, round);
+    d_hi = _mm_add_epi16(d_hi, round);
+    d_lo = _mm_srli_epi16(_mm_add_epi16(d_lo, _mm_srli_epi16(d_lo, 8)), 8);
+    d_hi = _mm_srli_epi16(_mm_add_epi16(d_hi, _mm_srli_epi16(d_hi, 8)), 8);
+
+    d = _mm_adds_epu8(s, _mm_packus_epi16(d_lo, d_hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), d);
+  }
+#endif
+
+  for (; i < count; ++i) {
+    auto s = src[i];
+    if (s == 0) {
+      continue;
+    }
+
+    auto inv = 255 - (s >> 24);
+    auto d = dst[i];
+    uint32_t r = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+      auto c = ((s >> shift) & 0xff) + div255(((d >> shift) & 0xff) * inv);
+      r |= std::min(c, uint32_t(255)) << shift;
+    }
+
+    dst[i] = r;
+  }
+}
+
+/**
+ * Returns true if the shape is a single full circle, as drawn by the point
+ * layer, and stores its center and radius
+ */
+static bool path_is_circle(
+    Path::const_iterator begin,
+    size_t size,
+    double* x,
+    double* y,
+    double* r) {
+  if (size != 2 || (*begin).command != PathCommand::MOVE_TO) {
+    return false;
+  }
+
+  auto arc = *++begin;
+  if (arc.command != PathCommand::ARC_TO ||
+      std::fabs(arc[4] - arc[3]) < M_PI * 2) {
+    return false;
+  }
+
+  *x = arc[0];
+  *y = arc[1];
+  *r = arc[2];
+  return std::isfinite(*x) && std::isfinite(*y) && std::isfinite(*r);
+}
+
+bool operator==(const MarkerSpriteKey& a, const MarkerSpriteKey& b) {
+  return
+      a.radius == b.radius &&
+      a.color == b.color &&
+      a.phase_x == b.phase_x &&
+      a.phase_y == b.phase_y;
+}
+
+size_t MarkerSpriteKeyHash::operator()(const MarkerSpriteKey& key) const {
+  size_t h = std::hash<double>{}(key.radius);
+  for (size_t i = 0; i < Color::kMaxComponents; ++i) {
+    h = h * 31 + std::hash<double>{}(key.color[i]);
+  }
+
+  return h * 31 + key.phase_x * kMarkerSpritePhases + key.phase_y;
+}
+
 Rasterizer::Rasterizer(
     uint32_t width_,
     uint32_t height_,
@@ -43,11 +177,7 @@ Rasterizer::Rasterizer(
     height(height_),
     dpi(dpi_),
     text_shaper(text_shaper_),
-    ft_ready(false) {
-  if (!FT_Init_FreeType(&ft)) {
-    ft_ready = true;
-  }
-
+    marker_sprite_pixels(0) {
   cr_surface = cairo_image_surface_create(
       CAIRO_FORMAT_ARGB32,
       width,
@@ -57,12 +187,32 @@ Rasterizer::Rasterizer(
 }
 
 Rasterizer::~Rasterizer() {
-  if (ft_ready) {
-    FT_Done_FreeType(ft);
-  }
-
   cairo_destroy(cr_ctx);
   cairo_surface_destroy(cr_surface);
+
+  for (const auto& f : font_faces) {
+    cairo_font_face_destroy(f.second);
+  }
+}
+
+static const cairo_user_data_key_t kFontFaceKey = {};
+
+cairo_font_face_t* Rasterizer::getFontFace(const text::FontRef& font) {
+  if (auto iter = font_faces.find(font->ft_face); iter != font_faces.end()) {
+    return iter->second;
+  }
+
+  /* cairo may keep the face alive after we release it, so the face holds
+     its own reference to the font */
+  auto cairo_face = cairo_ft_font_face_create_for_ft_face(font->ft_face, 0);
+  cairo_font_face_set_user_data(
+      cairo_face,
+      &kFontFaceKey,
+      new text::FontRef(font),
+      [] (void* font) { delete static_cast<text::FontRef*>(font); });
+
+  font_faces.emplace(font->ft_face, cairo_face);
+  return cairo_face;
 }
 
 Status Rasterizer::fillPath(const layer_ops::BrushFillOp& op) {
@@ -83,28 +233,202 @@ Status Rasterizer::fillPath(const layer_ops::BrushFillOp& op) {
   cairo_rectangle(cr_ctx, clip.x, clip.y, clip.w, clip.h);
   cairo_clip(cr_ctx);
   cairo_new_path(cr_ctx);
+  rasterize_path(cr_ctx, path.begin(), path.end());
+  cairo_fill(cr_ctx);
 
-  for (const auto& cmd : path) {
-    switch (cmd.command) {
-      case PathCommand::MOVE_TO:
-        cairo_move_to(cr_ctx, cmd[0], cmd[1]);
-        break;
-      case PathCommand::LINE_TO:
-        cairo_line_to(cr_ctx, cmd[0], cmd[1]);
-        break;
-      case PathCommand::ARC_TO:
-        cairo_arc(cr_ctx, cmd[0], cmd[1], cmd[2], cmd[3], cmd[4]);
-        break;
-      default:
-        break; // not yet implemented
+  return OK;
+}
+
+Status Rasterizer::fillPaths(const layer_ops::BrushFillBatchOp& op) {
+  const auto& clip = op.clip;
+  const auto& path = op.path;
+  const auto& style = op.style;
+
+  cairo_set_source_rgba(
+     cr_ctx,
+     style.color.red(),
+     style.color.green(),
+     style.color.blue(),
+     style.color.alpha());
+
+  cairo_rectangle(cr_ctx, clip.x, clip.y, clip.w, clip.h);
+  cairo_clip(cr_ctx);
+
+  Rectangle clip_bounds;
+  {
+    double x1, y1, x2, y2;
+    cairo_clip_extents(cr_ctx, &x1, &y1, &x2, &y2);
+    clip_bounds = Rectangle(x1, y1, x2 - x1, y2 - y1);
+  }
+
+  /* fill each shape separately so that overlapping shapes blend as usual.
+   * small circles are stamped from cached sprites instead; cairo has to be
+   * told whenever we switch between drawing through it and drawing directly
+   * to the surface */
+  bool surface_direct = false;
+  auto end = path.begin();
+  for (size_t i = 0; i < op.shapes.size(); ++i) {
+    auto size = i + 1 < op.shapes.size()
+        ? op.shapes[i + 1] - op.shapes[i]
+        : path.size() - op.shapes[i];
+
+    auto begin = end;
+    end = std::next(begin, size);
+
+    if (size < 2) {
+      continue;
     }
+
+    double cx;
+    double cy;
+    double radius;
+    if (path_is_circle(begin, size, &cx, &cy, &radius) &&
+        radius <= kMarkerSpriteMaxRadius) {
+      if (radius <= 0) {
+        continue;
+      }
+
+      if (!surface_direct) {
+        cairo_surface_flush(cr_surface);
+        surface_direct = true;
+      }
+
+      auto x = int64_t(std::floor(cx));
+      auto y = int64_t(std::floor(cy));
+
+      MarkerSpriteKey key;
+      key.radius =
+          std::max(std::round(radius * kMarkerSpritePhases), 1.0) /
+          kMarkerSpritePhases;
+      key.color = style.color;
+      key.phase_x = std::lround((cx - x) * kMarkerSpritePhases);
+      key.phase_y = std::lround((cy - y) * kMarkerSpritePhases);
+
+      if (key.phase_x == kMarkerSpritePhases) {
+        key.phase_x = 0;
+        ++x;
+      }
+
+      if (key.phase_y == kMarkerSpritePhases) {
+        key.phase_y = 0;
+        ++y;
+      }
+
+      if (auto sprite = getMarkerSprite(key); sprite) {
+        drawMarkerSprite(*sprite, x, y, clip_bounds);
+        continue;
+      }
+    }
+
+    if (surface_direct) {
+      cairo_surface_mark_dirty(cr_surface);
+      surface_direct = false;
+    }
+
+    cairo_new_path(cr_ctx);
+    rasterize_path(cr_ctx, begin, end);
+    cairo_fill(cr_ctx);
   }
 
-  cairo_fill(cr_ctx);
+  if (surface_direct) {
+    cairo_surface_mark_dirty(cr_surface);
+  }
 
   return OK;
 }
 
+const MarkerSprite* Rasterizer::getMarkerSprite(const MarkerSpriteKey& key) {
+  if (auto iter = marker_sprites.find(key); iter != marker_sprites.end()) {
+    return &iter->second;
+  }
+
+  MarkerSprite sprite;
+  sprite.offset = int32_t(std::ceil(key.radius)) + 1;
+  sprite.size = sprite.offset * 2 + 2;
+
+  auto pixels = size_t(sprite.size) * sprite.size;
+  if (marker_sprite_pixels + pixels > kMarkerSpriteCacheMaxPixels) {
+    return nullptr;
+  }
+
+  marker_sprite_pixels += pixels;
+
+  auto surface = cairo_image_surface_create(
+      CAIRO_FORMAT_ARGB32,
+      sprite.size,
+      sprite.size);
+
+  auto ctx = cairo_create(surface);
+  cairo_set_source_rgba(
+     ctx,
+     key.color.red(),
+     key.color.green(),
+     key.color.blue(),
+     key.color.alpha());
+
+  cairo_arc(
+      ctx,
+      sprite.offset + double(key.phase_x) / kMarkerSpritePhases,
+      sprite.offset + double(key.phase_y) / kMarkerSpritePhases,
+      key.radius,
+      0,
+      M_PI * 2);
+
+  cairo_fill(ctx);
+  cairo_destroy(ctx);
+  cairo_surface_flush(surface);
+
+  auto data = cairo_image_surface_get_data(surface);
+  auto stride = cairo_image_surface_get_stride(surface);
+  sprite.pixels.resize(sprite.size * sprite.size);
+  for (int32_t row = 0; row < sprite.size; ++row) {
+    memcpy(
+        sprite.pixels.data() + row * sprite.size,
+        data + row * stride,
+        sprite.size * sizeof(uint32_t));
+  }
+
+  cairo_surface_destroy(surface);
+
+  return &marker_sprites.emplace(key, std::move(sprite)).first->second;
+}
+
+void Rasterizer::drawMarkerSprite(
+    const MarkerSprite& sprite,
+    int64_t x,
+    int64_t y,
+    const Rectangle& clip) {
+  /* only touch pixels whose center is inside the clip */
+  auto clip_x1 = std::max(int64_t(std::ceil(clip.x - 0.5)), int64_t(0));
+  auto clip_y1 = std::max(int64_t(std::ceil(clip.y - 0.5)), int64_t(0));
+  auto clip_x2 = std::min(
+      int64_t(std::floor(clip.x + clip.w - 0.5)) + 1,
+      int64_t(width));
+  auto clip_y2 = std::min(
+      int64_t(std::floor(clip.y + clip.h - 0.5)) + 1,
+      int64_t(height));
+
+  auto x1 = std::max(x - sprite.offset, clip_x1);
+  auto y1 = std::max(y - sprite.offset, clip_y1);
+  auto x2 = std::min(x - sprite.offset + sprite.size, clip_x2);
+  auto y2 = std::min(y - sprite.offset + sprite.size, clip_y2);
+  if (x1 >= x2 || y1 >= y2) {
+    return;
+  }
+
+  auto data = cairo_image_surface_get_data(cr_surface);
+  auto stride = cairo_image_surface_get_stride(cr_surface);
+  for (auto row = y1; row < y2; ++row) {
+    auto src =
+        sprite.pixels.data() +
+        (row - y + sprite.offset) * sprite.size +
+        (x1 - x + sprite.offset);
+
+    auto dst = reinterpret_cast<uint32_t*>(data + row * stride) + x1;
+    blend_over_row(src, dst, x2 - x1);
+  }
+}
+
 Status Rasterizer::strokePath(const layer_ops::BrushStrokeOp& op) {
   const auto& clip = op.clip;
   const auto& path = op.path;
@@ -126,29 +450,23 @@ Status Rasterizer::strokePath(const layer_ops::BrushStrokeOp& op) {
   cairo_rectangle(cr_ctx, clip.x, clip.y, clip.w, clip.h);
   cairo_clip(cr_ctx);
   cairo_new_path(cr_ctx);
-
-  for (const auto& cmd : path) {
-    switch (cmd.command) {
-      case PathCommand::MOVE_TO:
-        cairo_move_to(cr_ctx, cmd[0], cmd[1]);
-        break;
-      case PathCommand::LINE_TO:
-        cairo_line_to(cr_ctx, cmd[0], cmd[1]);
-        break;
-      case PathCommand::ARC_TO:
-        cairo_arc(cr_ctx, cmd[0], cmd[1], cmd[2], cmd[3], cmd[4]);
-        break;
-      default:
-        break; // not yet implemented
-    }
-  }
-
+  rasterize_path(cr_ctx, path.begin(), path.end());
   cairo_stroke(cr_ctx);
 
   return OK;
 }
 
 Status Rasterizer::drawText(const layer_ops::TextSpanOp& op) {
+  /* fonts with embedded metrics are loaded only once they are drawn */
+  if (op.style.font.font_file.empty() && op.style.font.font_metrics) {
+    auto op_system = op;
+    if (!font_get_file(op.style.font, &op_system.style.font.font_file)) {
+      return ERROR;
+    }
+
+    return drawText(op_system);
+  }
+
   std::vector<text::GlyphPlacement> glyphs;
   auto rc = text::layoutText(
       op.text,
@@ -175,19 +493,9 @@ Status Rasterizer::drawTextGlyphs(
     const text::GlyphPlacement* glyphs,
     size_t glyph_count,
     const TextStyle& style) {
-  if (!ft_ready) {
-    return ERROR;
-  }
-
-  // FIXME cache
-  FT_Face ft_font;
-  if (FT_New_Face(ft, style.font.font_file.c_str(), 0, &ft_font)) {
-    return ERROR;
-  }
-
-  auto font_size_ft = style.font_size * (72.0 / dpi) * 64;
-  if (FT_Set_Char_Size(ft_font, 0, font_size_ft, dpi, dpi)) {
-    FT_Done_Face(ft_font);
+  text::FontRef font;
+  auto font_cache = text_shaper->getFontCache();
+  if (!font_cache->getFont(style.font.font_file, style.font_size, dpi, &font)) {
     return ERROR;
   }
 
@@ -198,8 +506,7 @@ Status Rasterizer::drawTextGlyphs(
      style.color.blue(),
      style.color.alpha());
 
-  auto cairo_face = cairo_ft_font_face_create_for_ft_face(ft_font, 0);
-  cairo_set_font_face(cr_ctx, cairo_face);
+  cairo_set_font_face(cr_ctx, getFontFace(font));
   cairo_set_font_size(cr_ctx, style.font_size);
 
   auto cairo_glyphs = cairo_glyph_allocate(glyph_count);
@@ -229,9 +536,6 @@ Status Rasterizer::drawTextGlyphs(
 
   cairo_show_glyphs(cr_ctx, cairo_glyphs, glyph_count);
   cairo_glyph_free(cairo_glyphs);
-  cairo_font_face_destroy(cairo_face);
-
-  FT_Done_Face(ft_font);
   return OK;
 }
 
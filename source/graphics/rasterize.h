@@ -46,10 +46,52 @@
 #include "layout.h"
 #include "layer.h"
 #include "text_layout.h"
+#include "font_cache.h"
 
 namespace plotfx {
 class Image;
 
+/**
+ * Circular markers up to this radius (in pixels) are drawn from sprites
+ */
+static const double kMarkerSpriteMaxRadius = 32;
+
+/**
+ * Number of subpixel positions per axis for which separate sprites are kept.
+ * Sprite radii are rounded to the same grid
+ */
+static const int kMarkerSpritePhases = 8;
+
+/**
+ * Maximum number of sprite pixels kept per rasterizer (4MB). Markers whose
+ * sprite would exceed the budget, e.g. because the radius or color varies
+ * from point to point, are drawn with cairo instead
+ */
+static const size_t kMarkerSpriteCacheMaxPixels = 1 << 20;
+
+/**
+ * A pre-rendered circular marker in premultiplied ARGB32. The marker center
+ * is at (offset + phase_x / kMarkerSpritePhases, offset + phase_y / ...)
+ */
+struct MarkerSprite {
+  int32_t size;
+  int32_t offset;
+  std::vector<uint32_t> pixels;
+};
+
+struct MarkerSpriteKey {
+  double radius;
+  Color color;
+  int phase_x;
+  int phase_y;
+};
+
+bool operator==(const MarkerSpriteKey& a, const MarkerSpriteKey& b);
+
+struct MarkerSpriteKeyHash {
+  size_t operator()(const MarkerSpriteKey& key) const;
+};
+
 class Rasterizer {
 public:
 
@@ -61,6 +103,19 @@ public:
   void clear(const Color& c);
 
   Status fillPath(const layer_ops::BrushFillOp& op);
+  Status fillPaths(const layer_ops::BrushFillBatchOp& op);
+
+  /**
+   * Returns the sprite for the key, rendering it if needed, or nullptr if the
+   * sprite cache is full
+   */
+  const MarkerSprite* getMarkerSprite(const MarkerSpriteKey& key);
+  void drawMarkerSprite(
+      const MarkerSprite& sprite,
+      int64_t x,
+      int64_t y,
+      const Rectangle& clip);
+
   Status strokePath(const layer_ops::BrushStrokeOp& op);
 
   Status drawText(const layer_ops::TextSpanOp& op);
@@ -69,6 +124,12 @@ public:
       size_t glyph_count,
       const TextStyle& style);
 
+  /**
+   * Returns the cairo font face for a cached font. Cairo faces are created
+   * once per font and kept until the rasterizer is destroyed
+   */
+  cairo_font_face_t* getFontFace(const text::FontRef& font);
+
   Status writeToFile(const std::string& path);
 
   std::string to_png() const;
@@ -79,10 +140,11 @@ public:
   uint32_t height;
   double dpi;
   std::shared_ptr<text::TextShaper> text_shaper;
-  FT_Library ft;
-  bool ft_ready;
   cairo_surface_t* cr_surface;
   cairo_t* cr_ctx;
+  std::unordered_map<MarkerSpriteKey, MarkerSprite, MarkerSpriteKeyHash> marker_sprites;
+  size_t marker_sprite_pixels;
+  std::unordered_map<FT_Face, cairo_font_face_t*> font_faces;
 };
 
 using RasterizerRef = std::shared_ptr<Rasterizer>;
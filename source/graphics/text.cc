@@ -34,6 +34,8 @@
 
 namespace plotfx {
 
+FontInfo::FontInfo() : font_metrics(nullptr) {}
+
 TextStyle::TextStyle() :
     direction(TextDirection::LTR) {}
 
@@ -36,14 +36,22 @@
 
 namespace plotfx {
 class Layer;
+struct FontMetrics;
 
 enum class TextDirection {
   LTR, RTL
 };
 
+/**
+ * A font. Fonts with embedded metrics (see `font_metrics.h`) may not have a
+ * font file; the file is then looked up only if it is needed for rasterizing
+ * or for shaping characters that are not covered by the metrics
+ */
 struct FontInfo {
+  FontInfo();
   std::string font_file;
   std::string font_family_css;
+  const FontMetrics* font_metrics;
 };
 
 struct TextStyle {
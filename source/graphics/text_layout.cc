@@ -41,28 +41,12 @@ Status text_measure_span(
     double dpi,
     const TextShaper* shaper,
     Rectangle* rect) {
-  double line_length = 0;
-  double top = 0.0f;
-  double bottom = 0.0f;
-
-  std::vector<GlyphInfo> glyphs;
-  auto rc = shaper->shapeText(
-      text,
-      font_info,
-      font_size,
-      dpi,
-      [&] (const GlyphInfo& gi) {
-        line_length += gi.advance_x;
-        top = std::min(-gi.metrics_ascender, top);
-        bottom = std::max(-gi.metrics_descender, bottom);
-        glyphs.emplace_back(gi);
-      });
-
-  if (rc != OK) {
+  ShapedRunRef run;
+  if (auto rc = shaper->shapeRun(text, font_info, font_size, dpi, &run); rc != OK) {
     return rc;
   }
 
-  *rect = Rectangle(0, top, line_length, bottom - top);
+  *rect = run->extents;
   return OK;
 }
 
@@ -75,27 +59,15 @@ Status layoutTextLTR(
     double dpi,
     const TextShaper* shaper,
     std::function<void (const GlyphPlacement&)> glyph_cb) {
-  double line_length;
-  std::vector<GlyphInfo> glyphs;
-  auto rc = shaper->shapeText(
-      text,
-      font_info,
-      font_size,
-      dpi,
-      [&] (const GlyphInfo& gi) {
-        line_length += gi.advance_x;
-        glyphs.emplace_back(gi);
-      });
-
-  if (rc != OK) {
+  ShapedRunRef run;
+  if (auto rc = shaper->shapeRun(text, font_info, font_size, dpi, &run); rc != OK) {
     return rc;
   }
 
   auto gx = x;
   auto gy = y;
 
-
-  for (const auto& gi : glyphs) {
+  for (const auto& gi : run->glyphs) {
     double baseline_offset = 0;
 
     GlyphPlacement g;
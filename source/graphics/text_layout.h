@@ -35,6 +35,10 @@ namespace plotfx {
 namespace text {
 class TextShaper;
 
+/**
+ * A shaped glyph. `codepoint` is the glyph id in the font file, or zero if
+ * the glyph was shaped from embedded metrics (see `font_metrics.h`)
+ */
 struct GlyphInfo {
   uint32_t codepoint;
   double advance_y;
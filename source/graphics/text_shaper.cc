@@ -28,19 +28,287 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <graphics/text_shaper.h>
+#include <graphics/font_lookup.h>
+#include <graphics/font_metrics.h>
 #include <iostream>
 
 namespace plotfx {
 namespace text {
 
 TextShaper::TextShaper() :
-    ft_ready(false),
-    hb_buf(hb_buffer_create()) {}
+    font_cache(new FontCache()),
+    hb_buf(hb_buffer_create()),
+    simple_shaping(true) {}
 
 TextShaper::~TextShaper() {
-  if (ft_ready) {
-    FT_Done_FreeType(ft);
+  hb_buffer_destroy(hb_buf);
+}
+
+bool operator==(const ShapedRunKey& a, const ShapedRunKey& b) {
+  return
+      a.font_size == b.font_size &&
+      a.dpi == b.dpi &&
+      a.simple_shaping == b.simple_shaping &&
+      a.text == b.text &&
+      a.font_file == b.font_file;
+}
+
+size_t ShapedRunKeyHash::operator()(const ShapedRunKey& key) const {
+  size_t h = std::hash<std::string>{}(key.text);
+  h = h * 31 + std::hash<std::string>{}(key.font_file);
+  h = h * 31 + std::hash<double>{}(key.font_size);
+  h = h * 31 + std::hash<double>{}(key.dpi);
+  return h * 31 + key.simple_shaping;
+}
+
+ShapedRunCache::ShapedRunCache(size_t capacity) : runs_(capacity) {}
+
+bool ShapedRunCache::get(const ShapedRunKey& key, ShapedRunRef* run) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto cached = runs_.get(key);
+  if (!cached) {
+    return false;
+  }
+
+  *run = *cached;
+  return true;
+}
+
+void ShapedRunCache::put(ShapedRunKey key, ShapedRunRef run) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  runs_.put(std::move(key), std::move(run));
+}
+
+void ShapedRunCache::setCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  runs_.setCapacity(capacity);
+}
+
+size_t ShapedRunCache::getCapacity() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return runs_.getCapacity();
+}
+
+size_t ShapedRunCache::size() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return runs_.size();
+}
+
+CacheStats ShapedRunCache::getStats() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return runs_.getStats();
+}
+
+void ShapedRunCache::clear() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  runs_.clear();
+}
+
+ShapedRunCache* shaped_run_cache() {
+  static ShapedRunCache cache;
+  return &cache;
+}
+
+static void hb_shape_latin(
+    hb_buffer_t* hb_buf,
+    hb_font_t* hb_font,
+    const char* text,
+    size_t text_len) {
+  hb_buffer_reset(hb_buf);
+  hb_buffer_set_direction(hb_buf, HB_DIRECTION_LTR);
+  hb_buffer_set_script(hb_buf, HB_SCRIPT_LATIN);
+  hb_buffer_add_utf8(hb_buf, text, text_len, 0, text_len);
+  hb_shape(hb_font, hb_buf, NULL, 0);
+}
+
+/**
+ * Decode the character at text[*pos] and return its index in the simple
+ * shaping table. Returns false for characters that are not in the table
+ */
+static bool simple_char_decode(
+    const std::string& text,
+    size_t* pos,
+    size_t* index) {
+  auto c = uint8_t(text[*pos]);
+  if (c >= 0x20 && c <= 0x7e) {
+    *index = c - 0x20;
+    *pos += 1;
+    return true;
+  }
+
+  /* U+00A0 to U+00FF are encoded as C2 A0..C2 BF and C3 80..C3 BF */
+  if ((c == 0xc2 || c == 0xc3) && *pos + 1 < text.size()) {
+    auto c2 = uint8_t(text[*pos + 1]);
+    auto codepoint = ((c & 0x1f) << 6) | (c2 & 0x3f);
+    if ((c2 & 0xc0) == 0x80 && codepoint >= 0xa0) {
+      *index = 0x5f + (codepoint - 0xa0);
+      *pos += 2;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Look up the glyph and advance of a character, shaping the character on its
+ * own if it was not used before
+ */
+static bool simple_table_glyph(
+    hb_buffer_t* hb_buf,
+    const FontEntry& font,
+    const char* text,
+    size_t text_len,
+    size_t index) {
+  auto& table = font.simple_table;
+  if (table.advances[index] == kFontSimpleUnknown) {
+    hb_shape_latin(hb_buf, font.hb_font, text, text_len);
+
+    uint32_t glyph_count;
+    auto glyph_infos = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
+    auto glyph_positions = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
+
+    if (glyph_count == 1 &&
+        glyph_positions[0].y_advance == 0 &&
+        glyph_positions[0].x_offset == 0 &&
+        glyph_positions[0].y_offset == 0) {
+      table.glyphs[index] = glyph_infos[0].codepoint;
+      table.advances[index] = glyph_positions[0].x_advance;
+    } else {
+      table.advances[index] = kFontSimpleComplex;
+    }
   }
+
+  return table.advances[index] != kFontSimpleComplex;
+}
+
+/**
+ * Look up the adjustment of the first character of a pair, shaping the pair
+ * if it was not used before. Pairs that HarfBuzz does not shape into the same
+ * two glyphs (e.g. ligatures) or that move the second glyph can not be shaped
+ * from the table
+ */
+static bool simple_table_kerning(
+    hb_buffer_t* hb_buf,
+    const FontEntry& font,
+    const char* text,
+    size_t text_len,
+    size_t index_left,
+    size_t index_right,
+    int32_t* kerning) {
+  auto& table = font.simple_table;
+  if (table.kerning.empty()) {
+    table.kerning.resize(
+        kFontSimpleCharCount * kFontSimpleCharCount,
+        kFontSimpleUnknown);
+  }
+
+  auto& pair = table.kerning[index_left * kFontSimpleCharCount + index_right];
+  if (pair == kFontSimpleUnknown) {
+    hb_shape_latin(hb_buf, font.hb_font, text, text_len);
+
+    uint32_t glyph_count;
+    auto glyph_infos = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
+    auto glyph_positions = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
+
+    int32_t value = 0;
+    if (glyph_count == 2) {
+      value = glyph_positions[0].x_advance - table.advances[index_left];
+    }
+
+    if (glyph_count == 2 &&
+        glyph_infos[0].codepoint == table.glyphs[index_left] &&
+        glyph_infos[1].codepoint == table.glyphs[index_right] &&
+        glyph_positions[1].x_advance == table.advances[index_right] &&
+        glyph_positions[0].y_advance == 0 &&
+        glyph_positions[1].y_advance == 0 &&
+        glyph_positions[0].x_offset == 0 &&
+        glyph_positions[0].y_offset == 0 &&
+        glyph_positions[1].x_offset == 0 &&
+        glyph_positions[1].y_offset == 0 &&
+        value > kFontSimpleComplex &&
+        value <= INT16_MAX) {
+      pair = value;
+    } else {
+      pair = kFontSimpleComplex;
+    }
+  }
+
+  *kerning = pair;
+  return pair != kFontSimpleComplex;
+}
+
+/**
+ * Shape a run of ASCII and Latin-1 text from the simple table of the font.
+ * The table is built by shaping single characters and pairs of characters with
+ * HarfBuzz, so the result is the same as shaping the whole run as long as the
+ * font only substitutes and positions glyphs based on pairs of characters,
+ * which is the case for the Latin text in common fonts. Returns false if the
+ * run can not be shaped from the table
+ */
+bool TextShaper::shapeRunSimple(
+    const std::string& text,
+    const FontEntry& font,
+    ShapedRun* run) const {
+  auto ascender = font.ft_face->size->metrics.ascender / 64.0;
+  auto descender = font.ft_face->size->metrics.descender / 64.0;
+
+  run->glyphs.clear();
+  run->glyphs.reserve(text.size());
+
+  double line_length = 0;
+  size_t prev_begin = 0;
+  size_t prev_index = 0;
+  for (size_t pos = 0; pos < text.size(); ) {
+    auto begin = pos;
+    size_t index;
+    if (!simple_char_decode(text, &pos, &index) ||
+        !simple_table_glyph(hb_buf, font, &text[begin], pos - begin, index)) {
+      return false;
+    }
+
+    if (begin > 0) {
+      int32_t kerning;
+      auto rc = simple_table_kerning(
+          hb_buf,
+          font,
+          &text[prev_begin],
+          pos - prev_begin,
+          prev_index,
+          index,
+          &kerning);
+
+      if (!rc) {
+        return false;
+      }
+
+      auto& prev = run->glyphs.back();
+      prev.advance_x += kerning / 64.0;
+      line_length += kerning / 64.0;
+    }
+
+    GlyphInfo g;
+    g.codepoint = font.simple_table.glyphs[index];
+    g.advance_x = font.simple_table.advances[index] / 64.0;
+    g.advance_y = 0;
+    g.metrics_ascender = ascender;
+    g.metrics_descender = descender;
+    run->glyphs.emplace_back(g);
+
+    line_length += g.advance_x;
+    prev_begin = begin;
+    prev_index = index;
+  }
+
+  double top = 0;
+  double bottom = 0;
+  if (!run->glyphs.empty()) {
+    top = std::min(-ascender, top);
+    bottom = std::max(-descender, bottom);
+  }
+
+  run->extents = Rectangle(0, top, line_length, bottom - top);
+  return true;
 }
 
 Status TextShaper::shapeText(
@@ -49,54 +317,105 @@ Status TextShaper::shapeText(
     double font_size,
     double dpi,
     std::function<void (const GlyphInfo&)> glyph_cb) const {
-  if (!ft_ready) {
-    if (FT_Init_FreeType(&ft)) {
+  ShapedRunRef run;
+  if (auto rc = shapeRun(text, font, font_size, dpi, &run); rc != OK) {
+    return rc;
+  }
+
+  for (const auto& g : run->glyphs) {
+    glyph_cb(g);
+  }
+
+  return OK;
+}
+
+Status TextShaper::shapeRun(
+    const std::string& text,
+    const FontInfo& font,
+    double font_size,
+    double dpi,
+    ShapedRunRef* run) const {
+  if (font.font_file.empty() && font.font_metrics) {
+    auto shaped = std::make_shared<ShapedRun>();
+    if (font_metrics_shape(*font.font_metrics, text, font_size, dpi, shaped.get())) {
+      *run = std::move(shaped);
+      return OK;
+    }
+
+    /* the text contains characters that are not in the embedded metrics */
+    FontInfo font_system = font;
+    if (!font_get_file(font, &font_system.font_file)) {
       return ERROR;
     }
 
-    ft_ready = true;
+    return shapeRun(text, font_system, font_size, dpi, run);
   }
 
-  // FIXME cache
-  FT_Face ft_font;
-  if (FT_New_Face(ft, font.font_file.c_str(), 0, &ft_font)) {
-    return ERROR;
+  ShapedRunKey key{text, font.font_file, font_size, dpi, simple_shaping};
+  if (shaped_run_cache()->get(key, run)) {
+    return OK;
   }
 
-  auto font_size_ft = font_size * (72.0 / dpi) * 64;
-  if (FT_Set_Char_Size(ft_font, 0, font_size_ft, dpi, dpi)) {
-    FT_Done_Face(ft_font);
+  FontRef font_entry;
+  if (!font_cache->getFont(font.font_file, font_size, dpi, &font_entry)) {
     return ERROR;
   }
 
-  auto hb_font = hb_ft_font_create_referenced(ft_font);
-
-  hb_buffer_reset(hb_buf);
-  hb_buffer_set_direction(hb_buf, HB_DIRECTION_LTR);
-  hb_buffer_set_script(hb_buf, HB_SCRIPT_LATIN);
+  auto shaped = std::make_shared<ShapedRun>();
+  if (simple_shaping && shapeRunSimple(text, *font_entry, shaped.get())) {
+    shaped_run_cache()->put(std::move(key), shaped);
+    *run = std::move(shaped);
+    return OK;
+  }
 
-  hb_buffer_add_utf8(hb_buf, text.data(), text.size(), 0, text.size());
-  hb_shape(hb_font, hb_buf, NULL, 0);
+  hb_shape_latin(hb_buf, font_entry->hb_font, text.data(), text.size());
 
   uint32_t glyph_count;
   auto glyph_infos = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
   auto glyph_positions = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
+
+  /* the font's ascender and descender are the same for all glyphs */
+  auto ascender = font_entry->ft_face->size->metrics.ascender / 64.0;
+  auto descender = font_entry->ft_face->size->metrics.descender / 64.0;
+
+  shaped->glyphs.clear();
+  shaped->glyphs.reserve(glyph_count);
+
+  double line_length = 0;
   for (size_t i = 0; i < glyph_count; ++i) {
     GlyphInfo g;
     g.codepoint = glyph_infos[i].codepoint;
     g.advance_x = glyph_positions[i].x_advance / 64.0;
     g.advance_y = glyph_positions[i].y_advance / 64.0;
-    g.metrics_ascender = ft_font->size->metrics.ascender / 64.0; // FIXME this is constant for all glyphs
-    g.metrics_descender = ft_font->size->metrics.descender / 64.0; // FIXME this is constant for all glyphs
-    glyph_cb(g);
+    g.metrics_ascender = ascender;
+    g.metrics_descender = descender;
+    shaped->glyphs.emplace_back(g);
+
+    line_length += g.advance_x;
   }
 
-  hb_font_destroy(hb_font);
-  FT_Done_Face(ft_font);
+  double top = 0;
+  double bottom = 0;
+  if (glyph_count > 0) {
+    top = std::min(-ascender, top);
+    bottom = std::max(-descender, bottom);
+  }
+
+  shaped->extents = Rectangle(0, top, line_length, bottom - top);
 
+  shaped_run_cache()->put(std::move(key), shaped);
+  *run = std::move(shaped);
   return OK;
 }
 
+void TextShaper::setSimpleShaping(bool enable) {
+  simple_shaping = enable;
+}
+
+FontCache* TextShaper::getFontCache() const {
+  return font_cache.get();
+}
+
 } // namespace text
 } // namespace plotfx
 
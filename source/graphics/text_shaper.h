@@ -31,6 +31,7 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <mutex>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
@@ -38,12 +39,80 @@
 #include <harfbuzz/hb-ft.h>
 #include <harfbuzz/hb-icu.h>
 
+#include "graphics/font_cache.h"
+#include "graphics/geometry.h"
 #include "graphics/text_layout.h"
 #include "text.h"
 
 namespace plotfx {
 namespace text {
 
+/**
+ * Default number of shaped runs kept in the process-wide run cache
+ */
+static const size_t kShapedRunCacheDefaultCapacity = 4096;
+
+/**
+ * The result of shaping a span of text: the glyphs and the extents of the
+ * span, where (0, 0) is the baseline of the first glyph
+ */
+struct ShapedRun {
+  std::vector<GlyphInfo> glyphs;
+  Rectangle extents;
+};
+
+using ShapedRunRef = std::shared_ptr<const ShapedRun>;
+
+/**
+ * Runs shaped by the simple path and by HarfBuzz are cached separately, so a
+ * shaper with simple shaping disabled is never served a simple run
+ */
+struct ShapedRunKey {
+  std::string text;
+  std::string font_file;
+  double font_size;
+  double dpi;
+  bool simple_shaping;
+};
+
+bool operator==(const ShapedRunKey& a, const ShapedRunKey& b);
+
+struct ShapedRunKeyHash {
+  size_t operator()(const ShapedRunKey& key) const;
+};
+
+/**
+ * A thread safe LRU cache of shaped runs. Measuring, laying out and drawing
+ * a label all shape the same text, so the text is only passed to HarfBuzz
+ * the first time; the cache is shared by all text shapers in the process,
+ * so repeated renders of the same chart do not shape any text at all
+ */
+class ShapedRunCache {
+public:
+
+  explicit ShapedRunCache(size_t capacity = kShapedRunCacheDefaultCapacity);
+
+  bool get(const ShapedRunKey& key, ShapedRunRef* run);
+  void put(ShapedRunKey key, ShapedRunRef run);
+
+  void setCapacity(size_t capacity);
+  size_t getCapacity() const;
+
+  size_t size() const;
+  CacheStats getStats() const;
+
+  void clear();
+
+protected:
+  mutable std::mutex mutex_;
+  LRUCache<ShapedRunKey, ShapedRunRef, ShapedRunKeyHash> runs_;
+};
+
+/**
+ * Returns the process-wide shaped run cache
+ */
+ShapedRunCache* shaped_run_cache();
+
 class TextShaper {
 public:
 
@@ -59,11 +128,41 @@ public:
       double dpi,
       std::function<void (const GlyphInfo&)> glyph_cb) const;
 
+  /**
+   * Shape a span of text or return the cached run if the same span was shaped
+   * before
+   */
+  Status shapeRun(
+      const std::string& text,
+      const FontInfo& font,
+      double font_size,
+      double dpi,
+      ShapedRunRef* run) const;
+
+  /**
+   * Enable or disable the simple shaping path (enabled by default). Runs that
+   * consist only of ASCII and Latin-1 characters are then laid out from a
+   * per-font table of glyph advances and pair adjustments instead of being
+   * passed to HarfBuzz; all other text is always shaped with HarfBuzz
+   */
+  void setSimpleShaping(bool enable);
+
+  /**
+   * Returns the font cache of this shaper. Rasterizers that draw the shaped
+   * text should load their fonts from the same cache
+   */
+  FontCache* getFontCache() const;
+
 protected:
-  double dpi;
-  mutable FT_Library ft;
-  mutable bool ft_ready;
+
+  bool shapeRunSimple(
+      const std::string& text,
+      const FontEntry& font,
+      ShapedRun* run) const;
+
+  std::unique_ptr<FontCache> font_cache;
   mutable hb_buffer_t* hb_buf;
+  bool simple_shaping;
 };
 
 } // namespace text
@@ -342,7 +342,7 @@ ReturnCode legend_configure(
   config.border_color = doc.border_color;
   config.text_color = doc.text_color;
 
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {
       "position",
       bind(
@@ -457,7 +457,7 @@ ReturnCode legend_configure_all(
     const plist::PropertyList& plist,
     const LegendItemMap& items,
     LegendMap* config) {
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {
       "legend",
       bind(
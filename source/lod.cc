@@ -0,0 +1,222 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <math.h>
+#include "lod.h"
+#include "config_helpers.h"
+
+namespace plotfx {
+
+static size_t lod_columns(
+    const std::vector<double>& x,
+    const std::vector<size_t>& index) {
+  if (index.empty()) {
+    return 0;
+  }
+
+  double min = x[index[0]];
+  double max = x[index[0]];
+  for (auto i : index) {
+    min = std::min(min, x[i]);
+    max = std::max(max, x[i]);
+  }
+
+  if (!std::isfinite(max - min)) {
+    return index.size();
+  }
+
+  return size_t(std::ceil(max - min)) + 1;
+}
+
+std::vector<size_t> lod_reduce(
+    LODMode mode,
+    const std::vector<double>& x,
+    const std::vector<double>& y,
+    const std::vector<size_t>& index) {
+  switch (mode) {
+    case LODMode::OFF:
+      return index;
+    case LODMode::M4:
+      return lod_m4(x, y, index);
+    case LODMode::LTTB:
+      return lod_lttb(
+          x,
+          y,
+          index,
+          lod_columns(x, index) * kLODPointsPerColumn);
+    case LODMode::AUTO:
+      if (index.size() > lod_columns(x, index) * kLODPointsPerColumn) {
+        return lod_m4(x, y, index);
+      } else {
+        return index;
+      }
+  }
+
+  return index;
+}
+
+void lod_reduce_band(
+    LODMode mode,
+    const std::vector<double>& x,
+    const std::vector<double>& y_upper,
+    const std::vector<double>& y_lower,
+    const std::vector<size_t>& index,
+    std::vector<size_t>* index_upper,
+    std::vector<size_t>* index_lower) {
+  *index_upper = lod_reduce(mode, x, y_upper, index);
+  *index_lower = lod_reduce(mode, x, y_lower, index);
+}
+
+std::vector<size_t> lod_m4(
+    const std::vector<double>& x,
+    const std::vector<double>& y,
+    const std::vector<size_t>& index) {
+  std::vector<size_t> reduced;
+
+  size_t run_begin = 0;
+  size_t run_min = 0;
+  size_t run_max = 0;
+  for (size_t k = 0; k <= index.size(); ++k) {
+    if (k > 0 &&
+        k < index.size() &&
+        std::floor(x[index[k]]) == std::floor(x[index[run_begin]])) {
+      if (y[index[k]] < y[index[run_min]]) {
+        run_min = k;
+      }
+
+      if (y[index[k]] > y[index[run_max]]) {
+        run_max = k;
+      }
+
+      continue;
+    }
+
+    /* flush the previous run */
+    if (k > 0) {
+      size_t keep[4] = { run_begin, run_min, run_max, k - 1 };
+      std::sort(keep, keep + 4);
+      for (size_t j = 0; j < 4; ++j) {
+        if (j == 0 || keep[j] != keep[j - 1]) {
+          reduced.push_back(index[keep[j]]);
+        }
+      }
+    }
+
+    run_begin = k;
+    run_min = k;
+    run_max = k;
+  }
+
+  return reduced;
+}
+
+std::vector<size_t> lod_lttb(
+    const std::vector<double>& x,
+    const std::vector<double>& y,
+    const std::vector<size_t>& index,
+    size_t threshold) {
+  const auto count = index.size();
+  if (threshold >= count || threshold < 3) {
+    return index;
+  }
+
+  std::vector<size_t> reduced;
+  reduced.reserve(threshold);
+  reduced.push_back(index[0]);
+
+  /* every bucket except the first and last one holds `bucket_size` points */
+  const double bucket_size = double(count - 2) / (threshold - 2);
+
+  size_t a = 0;
+  for (size_t b = 0; b < threshold - 2; ++b) {
+    /* average of the next bucket (or the last point) */
+    auto avg_begin = size_t(std::floor((b + 1) * bucket_size)) + 1;
+    auto avg_end = std::min(
+        size_t(std::floor((b + 2) * bucket_size)) + 1,
+        count);
+    double avg_x = 0;
+    double avg_y = 0;
+    for (auto k = avg_begin; k < avg_end; ++k) {
+      avg_x += x[index[k]];
+      avg_y += y[index[k]];
+    }
+
+    avg_x /= (avg_end - avg_begin);
+    avg_y /= (avg_end - avg_begin);
+
+    /* pick the point of the current bucket that spans the largest triangle */
+    auto range_begin = size_t(std::floor(b * bucket_size)) + 1;
+    auto range_end = size_t(std::floor((b + 1) * bucket_size)) + 1;
+    auto ax = x[index[a]];
+    auto ay = y[index[a]];
+
+    double area_max = -1;
+    size_t next = range_begin;
+    for (auto k = range_begin; k < range_end; ++k) {
+      auto area = std::fabs(
+          (ax - avg_x) * (y[index[k]] - ay) -
+          (ax - x[index[k]]) * (avg_y - ay));
+
+      if (area > area_max) {
+        area_max = area;
+        next = k;
+      }
+    }
+
+    reduced.push_back(index[next]);
+    a = next;
+  }
+
+  reduced.push_back(index[count - 1]);
+  return reduced;
+}
+
+ReturnCode lod_configure(
+    const plist::Property& prop,
+    LODMode* mode) {
+  if (!plist::is_value(prop)) {
+    return ReturnCode::errorf(
+        "EARG",
+        "incorrect number of arguments; expected: 1, got: $0",
+        prop.size());
+  }
+
+  static const EnumDefinitions<LODMode> defs = {
+    { "auto", LODMode::AUTO },
+    { "off", LODMode::OFF },
+    { "m4", LODMode::M4 },
+    { "lttb", LODMode::LTTB },
+  };
+
+  return parseEnum(defs, prop.value, mode);
+}
+
+} // namespace plotfx
+
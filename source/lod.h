@@ -0,0 +1,96 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <vector>
+#include "plist/plist.h"
+#include "utils/return_code.h"
+
+namespace plotfx {
+
+enum class LODMode {
+  AUTO, OFF, M4, LTTB
+};
+
+/**
+ * The maximum number of points per horizontal pixel that survive the
+ * reduction. M4 needs exactly four (first, last, min and max) to draw the
+ * same pixels as the full polyline
+ */
+static const size_t kLODPointsPerColumn = 4;
+
+/**
+ * Reduce a group of points (given as indexes into screen coordinate vectors)
+ * to at most kLODPointsPerColumn points per pixel column. Returns the kept
+ * indexes in their original order
+ */
+std::vector<size_t> lod_reduce(
+    LODMode mode,
+    const std::vector<double>& x,
+    const std::vector<double>& y,
+    const std::vector<size_t>& index);
+
+/**
+ * Reduce a band between an upper and a lower edge that share their x
+ * coordinates. The edges are reduced separately, so that the vertical extent
+ * of both edges is kept in every pixel column
+ */
+void lod_reduce_band(
+    LODMode mode,
+    const std::vector<double>& x,
+    const std::vector<double>& y_upper,
+    const std::vector<double>& y_lower,
+    const std::vector<size_t>& index,
+    std::vector<size_t>* index_upper,
+    std::vector<size_t>* index_lower);
+
+/**
+ * M4 aggregation: keep the first, last, minimum and maximum point of every
+ * run of consecutive points that fall into the same pixel column
+ */
+std::vector<size_t> lod_m4(
+    const std::vector<double>& x,
+    const std::vector<double>& y,
+    const std::vector<size_t>& index);
+
+/**
+ * Largest-Triangle-Three-Buckets downsampling to `threshold` points
+ */
+std::vector<size_t> lod_lttb(
+    const std::vector<double>& x,
+    const std::vector<double>& y,
+    const std::vector<size_t>& index,
+    size_t threshold);
+
+ReturnCode lod_configure(
+    const plist::Property& prop,
+    LODMode* mode);
+
+} // namespace plotfx
+
@@ -46,6 +46,7 @@
 
 using namespace std::placeholders;
 using std::ref;
+using std::cref;
 
 namespace plotfx {
 namespace plot {
@@ -113,7 +114,7 @@ ReturnCode configure_layer(
     LegendItemMap* legend_items,
     PlotConfig* config) {
   std::string type = "points";
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {"type", bind(&configure_string, _1, &type)},
   };
 
@@ -128,7 +129,8 @@ ReturnCode configure_layer(
   if (type == "area")
     layer_builder = elem_builder<area::PlotAreaConfig>(
         bind(&area::configure, _1, _2, _3, scales, legend_items, _4),
-        &area::draw);
+        &area::draw,
+        bind(&area::update, cref(scales), _1));
 
   if (type == "bars")
     layer_builder = elem_builder<bars::PlotBarsConfig>(
@@ -143,12 +145,14 @@ ReturnCode configure_layer(
   if (type == "lines")
     layer_builder = elem_builder<lines::PlotLinesConfig>(
         bind(&lines::configure, _1, _2, _3, scales, legend_items, _4),
-        &lines::draw);
+        &lines::draw,
+        bind(&lines::update, cref(scales), _1));
 
   if (type == "points")
     layer_builder = elem_builder<points::PlotPointsConfig>(
         bind(&points::configure, _1, _2, _3, scales, _4),
-        &points::draw);
+        &points::draw,
+        bind(&points::update, cref(scales), _1));
 
   if (!layer_builder) {
     return ReturnCode::errorf("EARG", "invalid layer type: '$0'", type);
@@ -170,8 +174,8 @@ ReturnCode configure_layers(
     const DomainMap& scales,
     LegendItemMap* legend_items,
     PlotConfig* config) {
-  static const ParserDefinitions pdefs_layer = {
-    {"layer", bind(&configure_layer, _1, doc, data, scales, legend_items, config)}
+  const ParserDefinitions pdefs_layer = {
+    {"layer", bind(&configure_layer, _1, doc, data, cref(scales), legend_items, config)}
   };
 
   return parseAll(plist, pdefs_layer);
@@ -180,7 +184,8 @@ ReturnCode configure_layers(
 ReturnCode configure_scales(
     const plist::PropertyList& plist,
     const DataContext& data,
-    DomainMap* scales) {
+    DomainMap* scales,
+    std::vector<std::pair<std::string, SeriesRef>>* scale_data) {
   DomainConfig domain_x;
   domain_x.padding = 0;
 
@@ -190,14 +195,16 @@ ReturnCode configure_scales(
   if (data.defaults.count(SCALE_DEFAULT_X) &&
       data.defaults.at(SCALE_DEFAULT_X)) {
     domain_fit(*data.defaults.at(SCALE_DEFAULT_X), &domain_x);
+    scale_data->emplace_back(SCALE_DEFAULT_X, data.defaults.at(SCALE_DEFAULT_X));
   }
 
   if (data.defaults.count(SCALE_DEFAULT_Y) &&
     data.defaults.at(SCALE_DEFAULT_Y)) {
     domain_fit(*data.defaults.at(SCALE_DEFAULT_Y), &domain_y);
+    scale_data->emplace_back(SCALE_DEFAULT_Y, data.defaults.at(SCALE_DEFAULT_Y));
   }
 
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {"scale-x", bind(&domain_configure, _1, &domain_x)},
     {"scale-x-min", bind(&configure_float_opt, _1, &domain_x.min)},
     {"scale-x-max", bind(&configure_float_opt, _1, &domain_x.max)},
@@ -231,7 +238,7 @@ ReturnCode configure_scales(
     std::string scale_x = SCALE_DEFAULT_X;
     std::string scale_y = SCALE_DEFAULT_Y;
 
-    static const ParserDefinitions pdefs = {
+    const ParserDefinitions pdefs = {
       {"x", configure_series_fn(data, &data_x1)},
       {"x-offset", configure_series_fn(data, &data_x2)},
       {"scale-x", bind(&configure_string, _1, &scale_x)},
@@ -259,6 +266,7 @@ ReturnCode configure_scales(
       }
 
       domain_fit(*data_x1, domain_x);
+      scale_data->emplace_back(scale_x, data_x1);
     }
 
     if (data_x2) {
@@ -268,6 +276,7 @@ ReturnCode configure_scales(
       }
 
       domain_fit(*data_x2, domain_x);
+      scale_data->emplace_back(scale_x, data_x2);
     }
 
     if (data_y1) {
@@ -277,6 +286,7 @@ ReturnCode configure_scales(
       }
 
       domain_fit(*data_y1, domain_y);
+      scale_data->emplace_back(scale_y, data_y1);
     }
 
     if (data_y2) {
@@ -286,6 +296,7 @@ ReturnCode configure_scales(
       }
 
       domain_fit(*data_y2, domain_y);
+      scale_data->emplace_back(scale_y, data_y2);
     }
   }
 
@@ -347,7 +358,7 @@ ReturnCode configure_style(
   auto domain_x = find_ptr(scales, SCALE_DEFAULT_X);
   auto domain_y = find_ptr(scales, SCALE_DEFAULT_Y);
 
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {"axis-top", bind(&parseAxisModeProp, _1, &config->axis_top.mode)},
     {"axis-top-scale", bind(&configure_string, _1, &config->axis_top.scale)},
     {"axis-top-format", bind(&confgure_format, _1, &config->axis_top.label_formatter)},
@@ -444,13 +455,15 @@ ReturnCode configure(
     const Document& doc,
     PlotConfig* config) {
   DataContext data = data_in;
-  DomainMap scales;
   LegendItemMap legend_items;
 
+  config->scales = std::make_shared<DomainMap>();
+  auto& scales = *config->scales;
+
   return try_chain({
     bind(&configure_datasource, ref(plist), &data),
     bind(&configure_data_refs, ref(plist), &data),
-    bind(&configure_scales, ref(plist), ref(data), &scales),
+    bind(&configure_scales, ref(plist), ref(data), &scales, &config->scale_data),
     bind(&configure_style, ref(plist), doc, &scales, ref(config)),
     bind(&configure_layers,
         ref(plist),
@@ -478,6 +491,39 @@ ReturnCode configure(
   });
 }
 
+ReturnCode update(PlotConfig* config) {
+  auto& scales = *config->scales;
+  for (const auto& [scale, series] : config->scale_data) {
+    auto domain = find_ptr(&scales, scale);
+    if (!domain) {
+      return ReturnCode::errorf("EARG", "scale not found: $0", scale);
+    }
+
+    domain_fit(*series, domain);
+  }
+
+  for (const auto& layer : config->layers) {
+    if (!layer->update) {
+      return ReturnCode::error("EARG", "the plot has layers that can't be updated");
+    }
+
+    if (auto rc = layer->update(); !rc) {
+      return rc;
+    }
+  }
+
+  if (auto rc = grid_resolve(scales, &config->grid); !rc) {
+    return rc;
+  }
+
+  return axis_resolve(
+      scales,
+      &config->axis_top,
+      &config->axis_right,
+      &config->axis_bottom,
+      &config->axis_left);
+}
+
 } // namespace plot
 } // namespace plotfx
 
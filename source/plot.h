@@ -55,6 +55,13 @@ struct PlotConfig {
   Measure margins[4];
   std::vector<ElementRef> layers;
   LegendMap legends;
+
+  /**
+   * The fitted scales and the series that were fitted to each of them. The
+   * layers keep a reference to the scales to read them in their `update`
+   */
+  std::shared_ptr<DomainMap> scales;
+  std::vector<std::pair<std::string, SeriesRef>> scale_data;
 };
 
 ReturnCode draw(
@@ -68,6 +75,13 @@ ReturnCode configure(
     const Document& doc,
     PlotConfig* config);
 
+/**
+ * Update the plot after the series it references grew in place. The scales
+ * are refitted from the series summaries, so the cost depends on the number of
+ * new values, not on the length of the series
+ */
+ReturnCode update(PlotConfig* config);
+
 } // namespace plot
 } // namespace plotfx
 
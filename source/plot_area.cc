@@ -49,24 +49,47 @@ ReturnCode draw(
     const PlotAreaConfig& config,
     const Rectangle& clip,
     Layer* layer) {
+  auto sx = domain_project(config.scale_x, *config.x, clip.x, clip.w, false);
+  auto sy = domain_project(config.scale_y, *config.y, clip.y, clip.h, true);
+
+  std::vector<double> sy_offset;
+  if (config.yoffset) {
+    sy_offset = domain_project(
+        config.scale_y,
+        *config.yoffset,
+        clip.y,
+        clip.h,
+        true);
+  } else {
+    auto y0 = domain_translate(config.scale_y, Value("0.0"));
+    sy_offset.resize(sy.size(), clip.y + (1.0 - y0) * clip.h);
+  }
+
   for (const auto& group : config.groups) {
-    Path path;
+    std::vector<size_t> index_upper;
+    std::vector<size_t> index_lower;
+    lod_reduce_band(
+        config.lod,
+        sx,
+        sy,
+        sy_offset,
+        group.index,
+        &index_upper,
+        &index_lower);
 
-    for (auto i : group.index) {
-      auto sx = clip.x + config.x[i] * clip.w;
-      auto sy = clip.y + (1.0 - config.y[i]) * clip.h;
+    Path path;
+    path.reserve(index_upper.size() + index_lower.size() + 1);
 
-      if (i == group.index[0]) {
-        path.moveTo(sx, sy);
+    for (auto i : index_upper) {
+      if (i == index_upper[0]) {
+        path.moveTo(sx[i], sy[i]);
       } else {
-        path.lineTo(sx, sy);
+        path.lineTo(sx[i], sy[i]);
       }
     }
 
-    for (auto i = group.index.rbegin(); i != group.index.rend(); ++i) {
-      auto sx = clip.x + config.x[*i] * clip.w;
-      auto sy = clip.y + (1.0 - config.yoffset[*i]) * clip.h;
-      path.lineTo(sx, sy);
+    for (auto i = index_lower.rbegin(); i != index_lower.rend(); ++i) {
+      path.lineTo(sx[*i], sy_offset[*i]);
     }
 
     path.closePath();
@@ -127,7 +150,9 @@ ReturnCode configure(
   DomainConfig color_domain;
   ColorScheme color_palette;
 
-  static const ParserDefinitions pdefs = {
+  LODMode lod = LODMode::AUTO;
+
+  const ParserDefinitions pdefs = {
     {"x", configure_series_fn(data, &data_x)},
     {"scale-x", bind(&configure_string, _1, &scale_x)},
     {"y", configure_series_fn(data, &data_y)},
@@ -137,6 +162,7 @@ ReturnCode configure(
     {"title", bind(&configure_string, _1, &title)},
     {"color", configure_color_opt(&color)},
     {"colors", configure_series_fn(data, &colors)},
+    {"lod", bind(&lod_configure, _1, &lod)},
   };
 
   if (auto rc = parseAll(plist, pdefs); !rc) {
@@ -148,9 +174,9 @@ ReturnCode configure(
     return ReturnCode::error("EARG", "the following properties are required: x, y");
   }
 
-  if ((data_x->size() != data_y->size()) ||
-      (data_yoffset && data_x->size() != data_yoffset->size()) ||
-      (data_group && data_x->size() != data_group->size())) {
+  if ((series_len(*data_x) != series_len(*data_y)) ||
+      (data_yoffset && series_len(*data_x) != series_len(*data_yoffset)) ||
+      (data_group && series_len(*data_x) != series_len(*data_group))) {
     return ReturnCode::error(
         "EARG",
         "the length of the 'x', 'y', 'x-offset', 'y-offset' and 'group' properties must be equal");
@@ -169,31 +195,36 @@ ReturnCode configure(
 
   /* group data */
   if (data_group) {
-    if (data_x->size() != data_group->size()) {
+    if (series_len(*data_x) != series_len(*data_group)) {
       return ERROR;
     }
 
     config->groups = plotfx::series_group(*data_group);
   } else {
     DataGroup g;
-    g.index = std::vector<size_t>(data_x->size());
+    g.index = std::vector<size_t>(series_len(*data_x));
     std::iota(g.index.begin(), g.index.end(), 0);
     config->groups.emplace_back(g);
   }
 
   /* setup config */
-  config->x = domain_translate(*domain_x, *data_x);
-  config->y = domain_translate(*domain_y, *data_y);
-  config->yoffset = domain_translate(
-      *domain_y,
-      data_yoffset
-          ? *data_yoffset
-          : std::vector<Value>(data_y->size(), "0.0"));
+  config->x = data_x;
+  config->y = data_y;
+  config->yoffset = data_yoffset;
+  config->scale_x = *domain_x;
+  config->scale_y = *domain_y;
+  config->scale_x_name = scale_x;
+  config->scale_y_name = scale_y;
+  config->group = data_group;
+  config->color = color;
+  config->color_series = colors;
+  config->color_palette = color_palette;
+  config->lod = lod;
 
   config->colors = fallback(
       color,
       series_to_colors(colors, color_domain, color_palette),
-      groups_to_colors(data_x->size(), config->groups, color_palette));
+      groups_to_colors(series_len(*data_x), config->groups, color_palette));
 
   /* build legend items */
   if (auto rc = build_legend(*config, title, legend_key, legend); !rc) {
@@ -203,6 +234,54 @@ ReturnCode configure(
   return OK;
 }
 
+ReturnCode update(
+    const DomainMap& scales,
+    PlotAreaConfig* config) {
+  /* per-point colors are fitted over the whole color series */
+  if (config->color_series) {
+    return ReturnCode::error("EARG", "layers with 'colors' can't be updated");
+  }
+
+  if ((series_len(*config->x) != series_len(*config->y)) ||
+      (config->yoffset && series_len(*config->x) != series_len(*config->yoffset)) ||
+      (config->group && series_len(*config->x) != series_len(*config->group))) {
+    return ReturnCode::error(
+        "EARG",
+        "the length of the 'x', 'y', 'x-offset', 'y-offset' and 'group' properties must be equal");
+  }
+
+  auto domain_x = find_ptr(scales, config->scale_x_name);
+  auto domain_y = find_ptr(scales, config->scale_y_name);
+  if (!domain_x || !domain_y) {
+    return ERROR;
+  }
+
+  config->scale_x = *domain_x;
+  config->scale_y = *domain_y;
+
+  /* the legend of a layer that was configured without data has no colors */
+  if (config->groups.size() == 1 && config->groups[0].index.empty()) {
+    return ReturnCode::error("EARG", "empty layers can't be updated");
+  }
+
+  auto count = series_len(*config->x);
+  if (auto rc = groups_extend(config->group, count, &config->groups); !rc) {
+    return rc;
+  }
+
+  /* groups are drawn in the color of their first value, so existing groups
+   * keep their colors and legend items */
+  if (!config->color) {
+    groups_to_colors_extend(
+        count,
+        config->groups,
+        config->color_palette,
+        &config->colors);
+  }
+
+  return OK;
+}
+
 } // namespace area
 } // namespace plot
 } // namespace plotfx
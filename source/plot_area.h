@@ -34,6 +34,7 @@
 #include <graphics/layer.h>
 #include <graphics/viewport.h>
 #include <source/domain.h>
+#include <source/lod.h>
 #include <source/element.h>
 #include <source/config_helpers.h>
 #include <source/utils/algo.h>
@@ -46,11 +47,20 @@ namespace plot {
 namespace area {
 
 struct PlotAreaConfig {
-  std::vector<double> x;
-  std::vector<double> y;
-  std::vector<double> yoffset;
+  SeriesRef x;
+  SeriesRef y;
+  SeriesRef yoffset;
+  DomainConfig scale_x;
+  DomainConfig scale_y;
+  std::string scale_x_name;
+  std::string scale_y_name;
+  SeriesRef group;
+  std::optional<Color> color;
+  SeriesRef color_series;
+  ColorScheme color_palette;
   std::vector<DataGroup> groups;
   std::vector<Color> colors;
+  LODMode lod;
 };
 
 ReturnCode draw(
@@ -66,6 +76,14 @@ ReturnCode configure(
     LegendItemMap* legend,
     PlotAreaConfig* config);
 
+/**
+ * Extend the layer after its series grew in place: copy the refitted domains
+ * and add the new values to their groups
+ */
+ReturnCode update(
+    const DomainMap& scales,
+    PlotAreaConfig* config);
+
 } // namespace area
 } // namespace plot
 } // namespace plotfx
@@ -71,6 +71,7 @@ ReturnCode draw_horizontal(
       (slot_width / group_cnt) *
       (group_cnt > 1 ? (1.0 - kDefaultBarGroupPadding) : 1.0);
 
+  FillBatch batch(layer, clip);
   for (size_t group_idx = 0; group_idx < config.groups.size(); ++group_idx) {
     const auto group = config.groups[group_idx];
 
@@ -93,17 +94,17 @@ ReturnCode draw_horizontal(
       FillStyle style;
       style.color = color;
 
-      Path path;
+      auto& path = batch.add(style);
       path.moveTo(sx1, sy - bar_width * 0.5);
       path.lineTo(sx2, sy - bar_width * 0.5);
       path.lineTo(sx2, sy + bar_width * 0.5);
       path.lineTo(sx1, sy + bar_width * 0.5);
       path.closePath();
-
-      fillPath(layer, clip, path, style);
     }
   }
 
+  batch.flush();
+
   for (size_t i = 0; i < config.labels.size(); ++i) {
     const auto& label_text = config.labels[i];
 
@@ -154,6 +155,7 @@ ReturnCode draw_vertical(
       (slot_width / group_cnt) *
       (group_cnt > 1 ? (1.0 - kDefaultBarGroupPadding) : 1.0);
 
+  FillBatch batch(layer, clip);
   for (size_t group_idx = 0; group_idx < config.groups.size(); ++group_idx) {
     const auto group = config.groups[group_idx];
 
@@ -176,17 +178,17 @@ ReturnCode draw_vertical(
       FillStyle style;
       style.color = color;
 
-      Path path;
+      auto& path = batch.add(style);
       path.moveTo(sx - bar_width * 0.5, sy1);
       path.lineTo(sx - bar_width * 0.5, sy2);
       path.lineTo(sx + bar_width * 0.5, sy2);
       path.lineTo(sx + bar_width * 0.5, sy1);
       path.closePath();
-
-      fillPath(layer, clip, path, style);
     }
   }
 
+  batch.flush();
+
   for (size_t i = 0; i < config.labels.size(); ++i) {
     const auto& label_text = config.labels[i];
 
@@ -280,7 +282,7 @@ ReturnCode configure(
   DomainConfig color_domain;
   ColorScheme color_palette;
 
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {"x", configure_series_fn(data, &data_x)},
     {"x-offset", configure_series_fn(data, &data_xoffset)},
     {"scale-x", bind(&configure_string, _1, &scale_x)},
@@ -304,16 +306,16 @@ ReturnCode configure(
     return ReturnCode::error("EARG", "the following properties are required: x, y");
   }
 
-  if ((data_x->size() != data_y->size()) ||
-      (data_xoffset && data_x->size() != data_xoffset->size()) ||
-      (data_yoffset && data_x->size() != data_yoffset->size()) ||
-      (data_group && data_x->size() != data_group->size())) {
+  if ((series_len(*data_x) != series_len(*data_y)) ||
+      (data_xoffset && series_len(*data_x) != series_len(*data_xoffset)) ||
+      (data_yoffset && series_len(*data_x) != series_len(*data_yoffset)) ||
+      (data_group && series_len(*data_x) != series_len(*data_group))) {
     return ReturnCode::error(
         "EARG",
         "the length of the 'x', 'y', 'y', 'yoffset' and 'group' properties must be equal");
   }
 
-  if (data_labels && (data_x->size() != data_labels->size())) {
+  if (data_labels && (series_len(*data_x) != series_len(*data_labels))) {
     return ReturnCode::error(
         "EARG",
         "the length of the 'x', 'y' and 'labels' properties must be equal");
@@ -332,14 +334,14 @@ ReturnCode configure(
 
   /* group data */
   if (data_group) {
-    if (data_x->size() != data_group->size()) {
+    if (series_len(*data_x) != series_len(*data_group)) {
       return ERROR;
     }
 
     config->groups = plotfx::series_group(*data_group);
   } else {
     DataGroup g;
-    g.index = std::vector<size_t>(data_x->size());
+    g.index = std::vector<size_t>(series_len(*data_x));
     std::iota(g.index.begin(), g.index.end(), 0);
     config->groups.emplace_back(g);
   }
@@ -348,28 +350,28 @@ ReturnCode configure(
   config->direction = direction;
 
   config->x = domain_translate(*domain_x, *data_x);
-  config->xoffset = domain_translate(
-      *domain_x,
-      data_xoffset
-          ? *data_xoffset
-          : std::vector<Value>(data_x->size(), "0.0"));
+  config->xoffset = data_xoffset
+      ? domain_translate(*domain_x, *data_xoffset)
+      : std::vector<double>(
+            series_len(*data_x),
+            domain_translate(*domain_x, Value("0.0")));
 
   config->y = domain_translate(*domain_y, *data_y);
-  config->yoffset = domain_translate(
-      *domain_y,
-      data_yoffset
-          ? *data_yoffset
-          : std::vector<Value>(data_y->size(), "0.0"));
+  config->yoffset = data_yoffset
+      ? domain_translate(*domain_y, *data_yoffset)
+      : std::vector<double>(
+            series_len(*data_y),
+            domain_translate(*domain_y, Value("0.0")));
 
   config->colors = fallback(
       color,
       series_to_colors(colors, color_domain, color_palette),
-      groups_to_colors(data_x->size(), config->groups, color_palette));
+      groups_to_colors(series_len(*data_x), config->groups, color_palette));
 
   config->label_font = doc.font_sans;
   config->label_font_size = doc.font_size;
   if (data_labels) {
-    config->labels = *data_labels;
+    config->labels = series_to_text(*data_labels);
   }
 
   /* build legend items */
@@ -86,11 +86,6 @@ ReturnCode grid_place_lines_geom(
   return OK;
 }
 
-using GridPlacement = std::function<
-    ReturnCode (
-        const DomainConfig& domain,
-        std::vector<double>* ticks)>;
-
 ReturnCode grid_configure_placement(
     const plist::Property& prop,
     GridPlacement* placement) {
@@ -113,23 +108,20 @@ ReturnCode grid_configure(
   Measure line_width;
   Color line_color = Color::fromRGB(.9, .9, .9); // TODO
 
-  GridPlacement placement_horiz;
-  GridPlacement placement_vert;
-
-  std::string scale_horiz = SCALE_DEFAULT_X;
-  std::string scale_vert = SCALE_DEFAULT_Y;
-  static const ParserDefinitions pdefs = {
+  grid->scale_horiz = SCALE_DEFAULT_X;
+  grid->scale_vert = SCALE_DEFAULT_Y;
+  const ParserDefinitions pdefs = {
     {
       "grid",
       configure_multiprop({
-        bind(&grid_configure_placement, _1, &placement_horiz),
-        bind(&grid_configure_placement, _1, &placement_vert)
+        bind(&grid_configure_placement, _1, &grid->placement_horiz),
+        bind(&grid_configure_placement, _1, &grid->placement_vert)
       })
     },
-    {"grid-x", bind(&grid_configure_placement, _1, &placement_horiz)},
-    {"grid-scale-x", bind(&configure_string, _1, &scale_horiz)},
-    {"grid-y", bind(&grid_configure_placement, _1, &placement_horiz)},
-    {"grid-scale-y", bind(&configure_string, _1, &scale_vert)},
+    {"grid-x", bind(&grid_configure_placement, _1, &grid->placement_horiz)},
+    {"grid-scale-x", bind(&configure_string, _1, &grid->scale_horiz)},
+    {"grid-y", bind(&grid_configure_placement, _1, &grid->placement_horiz)},
+    {"grid-scale-y", bind(&configure_string, _1, &grid->scale_vert)},
     {"grid-stroke", bind(&configure_measure_rel, _1, doc.dpi, doc.font_size, &line_width)},
   };
 
@@ -140,17 +132,23 @@ ReturnCode grid_configure(
   grid->line_width = measure_or(line_width, from_pt(kDefaultLineWidthPT, doc.dpi));
   grid->line_color = line_color;
 
-  auto domain_horiz = find_ptr(scales, scale_horiz);
-  auto domain_vert = find_ptr(scales, scale_vert);
+  return grid_resolve(scales, grid);
+}
+
+ReturnCode grid_resolve(
+    const DomainMap& scales,
+    GridlineDefinition* grid) {
+  auto domain_horiz = find_ptr(scales, grid->scale_horiz);
+  auto domain_vert = find_ptr(scales, grid->scale_vert);
 
-  if (domain_horiz && placement_horiz) {
-    if (auto rc = placement_horiz(*domain_horiz, &grid->ticks_horiz); !rc) {
+  if (domain_horiz && grid->placement_horiz) {
+    if (auto rc = grid->placement_horiz(*domain_horiz, &grid->ticks_horiz); !rc) {
       return rc;
     }
   }
 
-  if (domain_vert && placement_vert) {
-    if (auto rc = placement_vert(*domain_vert, &grid->ticks_vert); !rc) {
+  if (domain_vert && grid->placement_vert) {
+    if (auto rc = grid->placement_vert(*domain_vert, &grid->ticks_vert); !rc) {
       return rc;
     }
   }
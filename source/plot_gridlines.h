@@ -40,7 +40,16 @@
 namespace plotfx {
 namespace plot {
 
+using GridPlacement = std::function<
+    ReturnCode (
+        const DomainConfig& domain,
+        std::vector<double>* ticks)>;
+
 struct GridlineDefinition {
+  std::string scale_horiz;
+  std::string scale_vert;
+  GridPlacement placement_horiz;
+  GridPlacement placement_vert;
   std::vector<double> ticks_horiz;
   std::vector<double> ticks_vert;
   Measure line_width;
@@ -58,6 +67,13 @@ ReturnCode grid_configure(
     const DomainMap& scales,
     GridlineDefinition* grid);
 
+/**
+ * Place the grid lines on the (refitted) scales
+ */
+ReturnCode grid_resolve(
+    const DomainMap& scales,
+    GridlineDefinition* grid);
+
 } // namespace plot
 } // namespace plotfx
 
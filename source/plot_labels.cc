@@ -104,7 +104,7 @@ ReturnCode configure(
   config->label_font = doc.font_sans;
   config->label_font_size = doc.font_size;
 
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {"x", configure_series_fn(data, &data_x)},
     {"scale-x", bind(&configure_string, _1, &scale_x)},
     {"y", configure_series_fn(data, &data_y)},
@@ -121,8 +121,8 @@ ReturnCode configure(
     return ReturnCode::error("EARG", "the following properties are required: x, y, label");
   }
 
-  if ((data_x->size() != data_y->size()) ||
-      (data_x->size() != data_labels->size())) {
+  if ((series_len(*data_x) != series_len(*data_y)) ||
+      (series_len(*data_x) != series_len(*data_labels))) {
     return ReturnCode::error(
         "EARG",
         "the length of the 'x', 'y' and 'labels' properties must be equal");
@@ -142,7 +142,7 @@ ReturnCode configure(
   /* return element */
   config->x = domain_translate(*domain_x, *data_x);
   config->y = domain_translate(*domain_y, *data_y);
-  config->labels = *data_labels;
+  config->labels = series_to_text(*data_labels);
 
   return OK;
 }
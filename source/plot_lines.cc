@@ -49,16 +49,19 @@ ReturnCode draw(
     const PlotLinesConfig& config,
     const Rectangle& clip,
     Layer* layer) {
+  auto sx = domain_project(config.scale_x, *config.x, clip.x, clip.w, false);
+  auto sy = domain_project(config.scale_y, *config.y, clip.y, clip.h, true);
+
   for (const auto& group : config.groups) {
-    Path path;
-    for (auto i : group.index) {
-      auto sx = clip.x + config.x[i] * clip.w;
-      auto sy = clip.y + (1.0 - config.y[i]) * clip.h;
+    auto index = lod_reduce(config.lod, sx, sy, group.index);
 
-      if (i == group.index[0]) {
-        path.moveTo(sx, sy);
+    Path path;
+    path.reserve(index.size());
+    for (auto i : index) {
+      if (i == index[0]) {
+        path.moveTo(sx[i], sy[i]);
       } else {
-        path.lineTo(sx, sy);
+        path.lineTo(sx[i], sy[i]);
       }
     }
 
@@ -119,8 +122,9 @@ ReturnCode configure(
   ColorScheme color_palette;
 
   Measure line_width;
+  LODMode lod = LODMode::AUTO;
 
-  static const ParserDefinitions pdefs = {
+  const ParserDefinitions pdefs = {
     {"x", configure_series_fn(data, &data_x)},
     {"scale-x", bind(&configure_string, _1, &scale_x)},
     {"y", configure_series_fn(data, &data_y)},
@@ -130,6 +134,7 @@ ReturnCode configure(
     {"color", configure_color_opt(&color)},
     {"colors", configure_series_fn(data, &colors)},
     {"stroke", bind(&configure_measure_rel, _1, doc.dpi, doc.font_size, &line_width)},
+    {"lod", bind(&lod_configure, _1, &lod)},
   };
 
   if (auto rc = parseAll(plist, pdefs); !rc) {
@@ -141,8 +146,8 @@ ReturnCode configure(
     return ReturnCode::error("EARG", "the following properties are required: x, y");
   }
 
-  if ((data_x->size() != data_y->size()) ||
-      (data_group && data_x->size() != data_group->size())) {
+  if ((series_len(*data_x) != series_len(*data_y)) ||
+      (data_group && series_len(*data_x) != series_len(*data_group))) {
     return ReturnCode::error(
         "EARG",
         "the length of the 'x', 'y' and 'group' properties must be equal");
@@ -161,26 +166,35 @@ ReturnCode configure(
 
   /* group data */
   if (data_group) {
-    if (data_x->size() != data_group->size()) {
+    if (series_len(*data_x) != series_len(*data_group)) {
       return ERROR;
     }
 
     config->groups = plotfx::series_group(*data_group);
   } else {
     DataGroup g;
-    g.index = std::vector<size_t>(data_x->size());
+    g.index = std::vector<size_t>(series_len(*data_x));
     std::iota(g.index.begin(), g.index.end(), 0);
     config->groups.emplace_back(g);
   }
 
   /* setup config */
-  config->x = domain_translate(*domain_x, *data_x);
-  config->y = domain_translate(*domain_y, *data_y);
+  config->x = data_x;
+  config->y = data_y;
+  config->scale_x = *domain_x;
+  config->scale_y = *domain_y;
+  config->scale_x_name = scale_x;
+  config->scale_y_name = scale_y;
+  config->group = data_group;
+  config->color = color;
+  config->color_series = colors;
+  config->color_palette = color_palette;
   config->line_width = measure_or(line_width, from_pt(kDefaultLineWidthPT, doc.dpi));
+  config->lod = lod;
   config->colors = fallback(
       color,
       series_to_colors(colors, color_domain, color_palette),
-      groups_to_colors(data_x->size(), config->groups, color_palette));
+      groups_to_colors(series_len(*data_x), config->groups, color_palette));
 
   /* build legend items */
   if (auto rc = build_legend(*config, title, legend_key, legend); !rc) {
@@ -190,6 +204,53 @@ ReturnCode configure(
   return OK;
 }
 
+ReturnCode update(
+    const DomainMap& scales,
+    PlotLinesConfig* config) {
+  /* per-point colors are fitted over the whole color series */
+  if (config->color_series) {
+    return ReturnCode::error("EARG", "layers with 'colors' can't be updated");
+  }
+
+  if ((series_len(*config->x) != series_len(*config->y)) ||
+      (config->group && series_len(*config->x) != series_len(*config->group))) {
+    return ReturnCode::error(
+        "EARG",
+        "the length of the 'x', 'y' and 'group' properties must be equal");
+  }
+
+  auto domain_x = find_ptr(scales, config->scale_x_name);
+  auto domain_y = find_ptr(scales, config->scale_y_name);
+  if (!domain_x || !domain_y) {
+    return ERROR;
+  }
+
+  config->scale_x = *domain_x;
+  config->scale_y = *domain_y;
+
+  /* the legend of a layer that was configured without data has no colors */
+  if (config->groups.size() == 1 && config->groups[0].index.empty()) {
+    return ReturnCode::error("EARG", "empty layers can't be updated");
+  }
+
+  auto count = series_len(*config->x);
+  if (auto rc = groups_extend(config->group, count, &config->groups); !rc) {
+    return rc;
+  }
+
+  /* groups are drawn in the color of their first value, so existing groups
+   * keep their colors and legend items */
+  if (!config->color) {
+    groups_to_colors_extend(
+        count,
+        config->groups,
+        config->color_palette,
+        &config->colors);
+  }
+
+  return OK;
+}
+
 } // namespace lines
 } // namespace plot
 } // namespace plotfx
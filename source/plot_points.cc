@@ -29,6 +29,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <numeric>
+#include <unordered_set>
 #include "plot_points.h"
 #include <plotfx.h>
 #include <graphics/path.h>
@@ -49,13 +50,169 @@ static const double kDefaultPointSizeMinPT = 1;
 static const double kDefaultPointSizeMaxPT = 24;
 static const double kDefaultLabelPaddingEM = 0.4;
 
+/**
+ * A marker only counts as covered if the covered area extends this far (in
+ * pixels) beyond its edge, so that antialiased edges stay hidden as well
+ */
+static const double kCullCoverMarginPX = 1;
+
+struct MarkerBucket {
+  int64_t x;
+  int64_t y;
+  double size;
+  Color color;
+};
+
+bool operator==(const MarkerBucket& a, const MarkerBucket& b) {
+  return
+      a.x == b.x &&
+      a.y == b.y &&
+      a.size == b.size &&
+      a.color == b.color;
+}
+
+struct MarkerBucketHash {
+  size_t operator()(const MarkerBucket& b) const {
+    size_t h = std::hash<int64_t>{}(b.x);
+    h = h * 31 + std::hash<int64_t>{}(b.y);
+    h = h * 31 + std::hash<double>{}(b.size);
+    for (size_t i = 0; i < Color::kMaxComponents; ++i) {
+      h = h * 31 + std::hash<double>{}(b.color[i]);
+    }
+
+    return h;
+  }
+};
+
+/**
+ * Find the markers that can be skipped without changing the output. Markers
+ * are painted in order, so we walk them back to front: an opaque marker is
+ * invisible if a later marker with the same colour and size lands on the same
+ * pixel or (in COVERED mode) if the pixels it touches are already completely
+ * covered by later opaque markers. Translucent markers are never culled since
+ * overplotting them changes the output
+ */
+std::vector<bool> cull_points(
+    const PlotPointsConfig& config,
+    const Rectangle& clip,
+    const std::vector<double>& sx,
+    const std::vector<double>& sy) {
+  std::vector<bool> culled(sx.size(), false);
+  if (config.cull == PointCullMode::OFF) {
+    return culled;
+  }
+
+  auto marker_size = [&config] (size_t i) {
+    return config.sizes.empty()
+        ? 0
+        : config.sizes[i % config.sizes.size()].value;
+  };
+
+  /* coverage bitmap: a pixel is set once it is fully inside an opaque marker */
+  const auto cover_x = int64_t(std::floor(clip.x));
+  const auto cover_y = int64_t(std::floor(clip.y));
+  const auto cover_w = int64_t(std::ceil(clip.w)) + 1;
+  const auto cover_h = int64_t(std::ceil(clip.h)) + 1;
+  std::vector<bool> cover;
+  if (config.cull == PointCullMode::COVERED) {
+    cover.resize(cover_w * cover_h, false);
+  }
+
+  auto is_covered = [&] (double x, double y, double r) {
+    auto x0 = int64_t(std::floor(x - r)) - cover_x;
+    auto x1 = int64_t(std::floor(x + r)) - cover_x;
+    auto y0 = int64_t(std::floor(y - r)) - cover_y;
+    auto y1 = int64_t(std::floor(y + r)) - cover_y;
+    if (x0 < 0 || y0 < 0 || x1 >= cover_w || y1 >= cover_h) {
+      return false;
+    }
+
+    for (auto py = y0; py <= y1; ++py) {
+      for (auto px = x0; px <= x1; ++px) {
+        if (!cover[py * cover_w + px]) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  };
+
+  auto add_cover = [&] (double x, double y, double r) {
+    auto x0 = std::max(int64_t(std::floor(x - r)) - cover_x, int64_t(0));
+    auto x1 = std::min(int64_t(std::floor(x + r)) - cover_x, cover_w - 1);
+    auto y0 = std::max(int64_t(std::floor(y - r)) - cover_y, int64_t(0));
+    auto y1 = std::min(int64_t(std::floor(y + r)) - cover_y, cover_h - 1);
+    for (auto py = y0; py <= y1; ++py) {
+      for (auto px = x0; px <= x1; ++px) {
+        /* the pixel is inside if its farthest corner is inside */
+        auto dx = std::max(
+            std::fabs(px + cover_x - x),
+            std::fabs(px + cover_x + 1 - x));
+        auto dy = std::max(
+            std::fabs(py + cover_y - y),
+            std::fabs(py + cover_y + 1 - y));
+
+        if (dx * dx + dy * dy <= r * r) {
+          cover[py * cover_w + px] = true;
+        }
+      }
+    }
+  };
+
+  std::unordered_set<MarkerBucket, MarkerBucketHash> buckets;
+  for (size_t n = sx.size(); n-- > 0; ) {
+    const auto& color = config.colors.empty()
+        ? Color{}
+        : config.colors[n % config.colors.size()];
+
+    auto size = marker_size(n);
+
+    if (color.alpha() < 1.0) {
+      continue;
+    }
+
+    MarkerBucket bucket;
+    bucket.x = std::llround(sx[n]);
+    bucket.y = std::llround(sy[n]);
+    bucket.size = size;
+    bucket.color = color;
+
+    if (!buckets.insert(bucket).second) {
+      culled[n] = true;
+      continue;
+    }
+
+    if (config.cull != PointCullMode::COVERED) {
+      continue;
+    }
+
+    if (is_covered(sx[n], sy[n], size + kCullCoverMarginPX)) {
+      culled[n] = true;
+    } else {
+      add_cover(sx[n], sy[n], size);
+    }
+  }
+
+  return culled;
+}
+
 ReturnCode draw(
     const PlotPointsConfig& config,
     const Rectangle& clip,
     Layer* layer) {
-  for (size_t i = 0; i < config.x.size(); ++i) {
-    auto sx = clip.x + config.x[i] * clip.w;
-    auto sy = clip.y + (1.0 - config.y[i]) * clip.h;
+  auto sx = domain_project(config.scale_x, *config.x, clip.x, clip.w, false);
+  auto sy = domain_project(config.scale_y, *config.y, clip.y, clip.h, true);
+
+  auto culled = cull_points(config, clip, sx, sy);
+
+  FillBatch batch(layer, clip);
+
+  for (size_t i = 0; i < sx.size(); ++i) {
+    if (culled[i]) {
+      ++layer->stats.marks_culled;
+      continue;
+    }
 
     const auto& color = config.colors.empty()
         ? Color{}
@@ -69,12 +226,14 @@ ReturnCode draw(
     style.color = color;
 
     // TODO point style
-    Path path;
-    path.moveTo(sx + size, sy);
-    path.arcTo(sx, sy, size, 0, M_PI * 2);
-    fillPath(layer, clip, path, style);
+    auto& path = batch.add(style);
+    path.moveTo(sx[i] + size, sy[i]);
+    path.arcTo(sx[i], sy[i], size, 0, M_PI * 2);
+    ++layer->stats.marks_drawn;
   }
 
+  batch.flush();
+
   for (size_t i = 0; i < config.labels.size(); ++i) {
     const auto& label_text = config.labels[i];
 
@@ -86,9 +245,7 @@ ReturnCode draw(
         config.label_padding,
         from_em(kDefaultLabelPaddingEM, config.label_font_size));
 
-    Point p(
-        clip.x + config.x[i] * clip.w,
-        clip.y + (1.0 - config.y[i]) * clip.h - label_padding);
+    Point p(sx[i], sy[i] - label_padding);
 
     TextStyle style;
     style.font = config.label_font;
@@ -105,6 +262,25 @@ ReturnCode draw(
   return OK;
 }
 
+ReturnCode configure_cull(
+    const plist::Property& prop,
+    PointCullMode* value) {
+  if (!plist::is_value(prop)) {
+    return ReturnCode::errorf(
+        "EARG",
+        "incorrect number of arguments; expected: 1, got: $0",
+        prop.size());
+  }
+
+  static const EnumDefinitions<PointCullMode> defs = {
+    { "auto", PointCullMode::AUTO },
+    { "off", PointCullMode::OFF },
+    { "covered", PointCullMode::COVERED },
+  };
+
+  return parseEnum(defs, prop.value, value);
+}
+
 ReturnCode configure(
     const plist::PropertyList& plist,
     const DataContext& data,
@@ -130,7 +306,9 @@ ReturnCode configure(
   Measure size_min;
   Measure size_max;
 
-  static const ParserDefinitions pdefs = {
+  PointCullMode cull = PointCullMode::AUTO;
+
+  const ParserDefinitions pdefs = {
     {"x", configure_series_fn(data, &data_x)},
     {"scale-x", bind(&configure_string, _1, &scale_x)},
     {"y", configure_series_fn(data, &data_y)},
@@ -143,6 +321,7 @@ ReturnCode configure(
     {"size-max", bind(&configure_measure_rel, _1, doc.dpi, doc.font_size, &size_max)},
     {"sizes", configure_series_fn(data, &sizes)},
     {"labels", configure_series_fn(data, &data_labels)},
+    {"cull", bind(&configure_cull, _1, &cull)},
   };
 
   if (auto rc = parseAll(plist, pdefs); !rc) {
@@ -154,13 +333,13 @@ ReturnCode configure(
     return ReturnCode::error("EARG", "the following properties are required: x, y");
   }
 
-  if (data_x->size() != data_y->size()) {
+  if (series_len(*data_x) != series_len(*data_y)) {
     return ReturnCode::error(
         "EARG",
         "the length of the 'x' and 'y' properties must be equal");
   }
 
-  if (data_labels && (data_x->size() != data_labels->size())) {
+  if (data_labels && (series_len(*data_x) != series_len(*data_labels))) {
     return ReturnCode::error(
         "EARG",
         "the length of the 'x', 'y' and 'labels' properties must be equal");
@@ -178,23 +357,32 @@ ReturnCode configure(
   }
 
   /* group data */
-  std::vector<DataGroup> groups;
   if (data_group) {
-    if (data_x->size() != data_group->size()) {
+    if (series_len(*data_x) != series_len(*data_group)) {
       return ERROR;
     }
 
-    groups = plotfx::series_group(*data_group);
+    config->groups = plotfx::series_group(*data_group);
   } else {
     DataGroup g;
-    g.index = std::vector<size_t>(data_x->size());
+    g.index = std::vector<size_t>(series_len(*data_x));
     std::iota(g.index.begin(), g.index.end(), 0);
-    groups.emplace_back(g);
+    config->groups.emplace_back(g);
   }
 
   /* return element */
-  config->x = domain_translate(*domain_x, *data_x);
-  config->y = domain_translate(*domain_y, *data_y);
+  config->x = data_x;
+  config->y = data_y;
+  config->scale_x = *domain_x;
+  config->scale_y = *domain_y;
+  config->scale_x_name = scale_x;
+  config->scale_y_name = scale_y;
+  config->group = data_group;
+  config->color = color;
+  config->color_series = colors;
+  config->color_palette = color_palette;
+  config->size_series = sizes;
+  config->label_series = data_labels;
 
   config->sizes = fallback(
       size,
@@ -208,12 +396,63 @@ ReturnCode configure(
   config->colors = fallback(
       color,
       series_to_colors(colors, color_domain, color_palette),
-      groups_to_colors(data_x->size(), groups, color_palette));
+      groups_to_colors(series_len(*data_x), config->groups, color_palette));
+
+  config->cull = cull;
 
   config->label_font = doc.font_sans;
   config->label_font_size = doc.font_size;
   if (data_labels) {
-    config->labels = *data_labels;
+    config->labels = series_to_text(*data_labels);
+  }
+
+  return OK;
+}
+
+ReturnCode update(
+    const DomainMap& scales,
+    PlotPointsConfig* config) {
+  /* per-point colors and sizes are fitted over the whole series */
+  if (config->color_series || config->size_series) {
+    return ReturnCode::error(
+        "EARG",
+        "layers with 'colors' or 'sizes' can't be updated");
+  }
+
+  auto count = series_len(*config->x);
+  if ((series_len(*config->y) != count) ||
+      (config->group && series_len(*config->group) != count) ||
+      (config->label_series && series_len(*config->label_series) != count)) {
+    return ReturnCode::error(
+        "EARG",
+        "the length of the 'x', 'y' and 'labels' properties must be equal");
+  }
+
+  auto domain_x = find_ptr(scales, config->scale_x_name);
+  auto domain_y = find_ptr(scales, config->scale_y_name);
+  if (!domain_x || !domain_y) {
+    return ERROR;
+  }
+
+  config->scale_x = *domain_x;
+  config->scale_y = *domain_y;
+
+  if (auto rc = groups_extend(config->group, count, &config->groups); !rc) {
+    return rc;
+  }
+
+  if (!config->color) {
+    groups_to_colors_extend(
+        count,
+        config->groups,
+        config->color_palette,
+        &config->colors);
+  }
+
+  if (config->label_series) {
+    for (auto i = config->labels.size(); i < count; ++i) {
+      config->labels.emplace_back(series_value_at(*config->label_series, i));
+    }
   }
 
   return OK;
@@ -43,9 +43,24 @@ namespace plotfx {
 namespace plot {
 namespace points {
 
+enum class PointCullMode {
+  AUTO, OFF, COVERED
+};
+
 struct PlotPointsConfig {
-  std::vector<double> x;
-  std::vector<double> y;
+  SeriesRef x;
+  SeriesRef y;
+  DomainConfig scale_x;
+  DomainConfig scale_y;
+  std::string scale_x_name;
+  std::string scale_y_name;
+  SeriesRef group;
+  std::vector<DataGroup> groups;
+  std::optional<Color> color;
+  SeriesRef color_series;
+  ColorScheme color_palette;
+  SeriesRef size_series;
+  SeriesRef label_series;
   std::vector<Color> colors;
   std::vector<Measure> sizes;
   std::vector<std::string> labels;
@@ -53,6 +68,7 @@ struct PlotPointsConfig {
   Measure label_padding;
   Measure label_font_size;
   Color label_color;
+  PointCullMode cull;
 };
 
 ReturnCode draw(
@@ -67,6 +83,14 @@ ReturnCode configure(
     const DomainMap& scales,
     PlotPointsConfig* config);
 
+/**
+ * Extend the layer after its series grew in place: copy the refitted domains
+ * and assign colors and labels to the new points
+ */
+ReturnCode update(
+    const DomainMap& scales,
+    PlotPointsConfig* config);
+
 } // namespace points
 } // namespace plot
 } // namespace plotfx
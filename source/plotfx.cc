@@ -29,7 +29,12 @@
  */
 #include "plotfx.h"
 #include "document.h"
+#include "data_binary.h"
+#include "graphics/font_lookup.h"
+#include "plist/plist_parser.h"
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <fstream>
 #include <sstream>
 
@@ -40,13 +45,79 @@ plotfx_t* plotfx_init() {
   return ctx.release();
 }
 
+/**
+ * Collect the parse error counts of all columns that mix numbers and other
+ * values. Columns in which no value is a number are plain text columns and
+ * are not reported.
+ */
+static void ctx_collect_parse_errors(Context* ctx) {
+  std::map<std::string, size_t> errors;
+  for (const auto& table : ctx->document->data.file_cache->csv_tables) {
+    for (const auto& [name, series] : table.second) {
+      if (series->parse_errors == 0) {
+        continue;
+      }
+
+      auto values = std::count_if(
+          series->text.begin(),
+          series->text.end(),
+          [] (const Value& v) { return !v.empty(); });
+
+      if (series->parse_errors < size_t(values)) {
+        errors[name] += series->parse_errors;
+      }
+    }
+  }
+
+  ctx->parse_errors.assign(errors.begin(), errors.end());
+}
+
+/**
+ * Build the document from the stored configuration and variables. When the
+ * document is rebuilt because a variable changed, the data files loaded by the
+ * previous document are reused.
+ */
+static ReturnCode ctx_load_document(Context* ctx) {
+  auto doc = std::make_unique<Document>();
+  doc->data.threads = ctx->threads;
+  doc->data.vars = SeriesMap(ctx->vars.begin(), ctx->vars.end());
+  if (ctx->document) {
+    doc->data.file_cache = ctx->document->data.file_cache;
+  }
+
+  ctx->document.reset();
+  ctx->vars_changed = false;
+  ctx->vars_appended = false;
+
+  if (auto rc = document_load(ctx->config, doc.get()); !rc) {
+    return rc;
+  }
+
+  ctx->document = std::move(doc);
+  ++ctx->document_loads;
+  ctx_collect_parse_errors(ctx);
+  return OK;
+}
+
 int plotfx_configure(
     plotfx_t* ctx,
     const char* config) {
-  auto& doc = static_cast<Context*>(ctx)->document;
-  doc.reset(new Document());
+  auto c = static_cast<Context*>(ctx);
+  c->document.reset();
 
-  if (auto rc = document_load(config, doc.get()); !rc) {
+  std::string config_str(config);
+  plist::PropertyListParser plist_parser(config_str.data(), config_str.size());
+  c->config.clear();
+  if (!plist_parser.parse(&c->config)) {
+    ctx_seterrf(
+        ctx,
+        StringUtil::format(
+            "invalid element specification: $0",
+            plist_parser.get_error()));
+    return ERROR;
+  }
+
+  if (auto rc = ctx_load_document(c); !rc) {
     ctx_seterr(ctx, rc);
     return ERROR;
   }
@@ -72,13 +143,182 @@ int plotfx_configure_file(
 }
 
 int plotfx_render_file(plotfx_t* ctx, const char* path, const char* format) {
-  const auto& doc = static_cast<const Context*>(ctx)->document;
+  return plotfx_render_files(ctx, &path, &format, nullptr, 1);
+}
+
+int plotfx_render_files(
+    plotfx_t* ctx,
+    const char** paths,
+    const char** formats,
+    const double* scales,
+    size_t count) {
+  auto c = static_cast<Context*>(ctx);
+  if (c->vars_appended && !c->vars_changed && c->document) {
+    c->vars_appended = false;
+    if (document_update(c->document.get())) {
+      ++c->document_updates;
+    } else {
+      c->vars_changed = true;
+    }
+  }
+
+  if (c->vars_changed && !c->config.empty()) {
+    if (auto rc = ctx_load_document(c); !rc) {
+      ctx_seterr(ctx, rc);
+      return ERROR;
+    }
+  }
+
+  const auto& doc = c->document;
   if (!doc) {
     ctx_seterrf(ctx, "no configuration loaded");
     return ERROR;
   }
 
-  if (auto rc = document_render(*doc, format, path); !rc) {
+  std::vector<RenderTarget> targets(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto& target = targets[i];
+    target.filename = paths[i];
+
+    if (formats && formats[i]) {
+      target.format = formats[i];
+    } else if (StringUtil::endsWith(target.filename, ".svg")) {
+      target.format = "svg";
+    } else if (StringUtil::endsWith(target.filename, ".png")) {
+      target.format = "png";
+    }
+
+    if (scales) {
+      target.scale = scales[i];
+    }
+  }
+
+  auto rc = document_render_targets(*doc, targets, c->threads, &c->stats);
+  if (!rc) {
+    ctx_seterr(ctx, rc);
+    return ERROR;
+  }
+
+  return OK;
+}
+
+void plotfx_set_threads(plotfx_t* ctx, size_t threads) {
+  static_cast<Context*>(ctx)->threads = threads;
+}
+
+void plotfx_set_font_cache(const char* path) {
+  font_lookup_set_cache_file(path ? path : "");
+}
+
+void plotfx_destroy(plotfx_t* ctx) {
+  delete static_cast<Context*>(ctx);
+}
+
+static void ctx_setvar(plotfx_t* ctx, const char* name, size_t name_len, Series s) {
+  auto c = static_cast<Context*>(ctx);
+  c->vars[std::string(name, name_len)] = std::make_shared<Series>(std::move(s));
+  c->vars_changed = true;
+}
+
+void plotfx_setvar_f64(
+    plotfx_t* ctx,
+    const char* name,
+    size_t name_len,
+    double value) {
+  ctx_setvar(ctx, name, name_len, series_from_float({ value }));
+}
+
+void plotfx_setvar_f64v(
+    plotfx_t* ctx,
+    const char* name,
+    size_t name_len,
+    const double* values,
+    size_t value_count) {
+  ctx_setvar(
+      ctx,
+      name,
+      name_len,
+      series_from_float(std::vector<double>(values, values + value_count)));
+}
+
+void plotfx_setvar_f64v_borrowed(
+    plotfx_t* ctx,
+    const char* name,
+    size_t name_len,
+    const double* values,
+    size_t value_count) {
+  ctx_setvar(ctx, name, name_len, series_borrow_float(values, value_count));
+}
+
+void plotfx_setvar_str(
+    plotfx_t* ctx,
+    const char* name,
+    size_t name_len,
+    const char* value,
+    size_t value_len) {
+  std::vector<Value> values = { Value(value, value_len) };
+  ctx_setvar(ctx, name, name_len, series_from_text(std::move(values)));
+}
+
+void plotfx_setvar_strv(
+    plotfx_t* ctx,
+    const char* name,
+    size_t name_len,
+    const char** values,
+    const size_t* value_lens,
+    size_t value_count) {
+  std::vector<std::string_view> value_refs;
+  value_refs.reserve(value_count);
+  for (size_t i = 0; i < value_count; ++i) {
+    value_refs.emplace_back(values[i], value_lens[i]);
+  }
+
+  ctx_setvar(ctx, name, name_len, series_from_text(value_refs));
+}
+
+int plotfx_append_f64v(
+    plotfx_t* ctx,
+    const char* name,
+    size_t name_len,
+    const double* values,
+    size_t value_count) {
+  auto c = static_cast<Context*>(ctx);
+  auto var = c->vars.find(std::string(name, name_len));
+  if (var == c->vars.end()) {
+    ctx_seterrf(
+        ctx,
+        StringUtil::format("variable not found: $0", std::string(name, name_len)));
+    return ERROR;
+  }
+
+  if (auto rc = series_append_float(var->second.get(), values, value_count); !rc) {
+    ctx_seterr(ctx, rc);
+    return ERROR;
+  }
+
+  c->vars_appended = true;
+  return OK;
+}
+
+int plotfx_write_binary(
+    plotfx_t* ctx,
+    const char* path,
+    const char** names,
+    size_t name_count) {
+  auto c = static_cast<Context*>(ctx);
+
+  std::vector<BinaryColumn> columns;
+  for (size_t i = 0; i < name_count; ++i) {
+    auto var = c->vars.find(names[i]);
+    if (var == c->vars.end()) {
+      ctx_seterrf(ctx, StringUtil::format("variable not found: $0", names[i]));
+      return ERROR;
+    }
+
+    columns.emplace_back(var->first, var->second);
+  }
+
+  if (auto rc = binary_write(path, columns); !rc) {
     ctx_seterr(ctx, rc);
     return ERROR;
   }
@@ -90,3 +330,76 @@ const char* plotfx_geterror(const plotfx_t* ctx) {
   return static_cast<const Context*>(ctx)->error.c_str();
 }
 
+size_t plotfx_getstat(const plotfx_t* ctx, const char* name) {
+  auto c = static_cast<const Context*>(ctx);
+  const auto& stats = c->stats;
+  std::string_view key(name);
+
+  if (key == "marks_drawn") {
+    return stats.marks_drawn;
+  }
+
+  if (key == "marks_culled") {
+    return stats.marks_culled;
+  }
+
+  if (key == "document_loads") {
+    return c->document_loads;
+  }
+
+  if (key == "document_updates") {
+    return c->document_updates;
+  }
+
+  if (!c->document) {
+    return 0;
+  }
+
+  const auto& file_cache = *c->document->data.file_cache;
+  if (key == "csv_cache_hits") {
+    return file_cache.csv_stats.hits;
+  }
+
+  if (key == "csv_cache_misses") {
+    return file_cache.csv_stats.misses;
+  }
+
+  if (key == "binary_cache_hits") {
+    return file_cache.binary_stats.hits;
+  }
+
+  if (key == "binary_cache_misses") {
+    return file_cache.binary_stats.misses;
+  }
+
+  if (key == "parse_errors") {
+    size_t total = 0;
+    for (const auto& column : c->parse_errors) {
+      total += column.second;
+    }
+
+    return total;
+  }
+
+  std::string_view column_prefix = "parse_errors:";
+  if (key.substr(0, column_prefix.size()) == column_prefix) {
+    auto column = key.substr(column_prefix.size());
+    for (const auto& [name, count] : c->parse_errors) {
+      if (name == column) {
+        return count;
+      }
+    }
+  }
+
+  return 0;
+}
+
+const char* plotfx_getstat_column(const plotfx_t* ctx, size_t index) {
+  const auto& parse_errors = static_cast<const Context*>(ctx)->parse_errors;
+  if (index >= parse_errors.size()) {
+    return nullptr;
+  }
+
+  return parse_errors[index].first.c_str();
+}
+
@@ -36,7 +36,7 @@
  * How to use:
  *  1) Call `plotfx_init_*` to create a new context, for example `plotfx_init_svgfile`
  *  2) Call `plotfx_configure` and pass the configuration string
- *  3) Optional: Call `plotfx_setvar` to override/set dynamic variables
+ *  3) Optional: Call `plotfx_setvar_*` to override/set dynamic variables
  *  4) Call `plotfx_submit`
  *  5) Optional: Retrieve the result using `plotfx_getimage`
  *  6) Optional: Repeat steps 2..6
@@ -63,6 +63,24 @@ plotfx_t* plotfx_init();
  */
 int plotfx_render_file(plotfx_t* ctx, const char* path, const char* format);
 
+/**
+ * Render the context to several files at once. The document is laid out and
+ * drawn only once and the result is then written to every file, using the
+ * number of threads set with `plotfx_set_threads`.
+ *
+ * `formats` and `scales` may be nullptr, as may single entries of `formats`;
+ * a missing format is inferred from the filename and a missing scale means
+ * the original size. A scale of 0.25 renders a quarter-size thumbnail.
+ *
+ * @returns: One (1) on success and zero (0) if an error has occured
+ */
+int plotfx_render_files(
+    plotfx_t* ctx,
+    const char** paths,
+    const char** formats,
+    const double* scales,
+    size_t count);
+
 /**
  * Render the context to an SVG file. The result image will
  * be written to the provided filesystem path once you call `plotfx_Submit`
@@ -96,6 +114,23 @@ int plotfx_configure_file(
     plotfx_t* ctx,
     const char* path);
 
+/**
+ * Set the number of threads that are used to load large data files and to
+ * write the outputs of `plotfx_render_files`. Zero means one thread per core;
+ * the default is one. Data files are loaded when the configuration is set, so
+ * this must be called before `plotfx_configure`.
+ */
+void plotfx_set_threads(plotfx_t* ctx, size_t threads);
+
+/**
+ * Remember font lookups in the given file, so that later processes can skip
+ * the (slow) fontconfig initialization. The file is created if it does not
+ * exist and is ignored once the fontconfig configuration or the installed
+ * fonts change. This setting applies to all contexts in the process and must
+ * be made before `plotfx_configure` to take effect. Pass nullptr to disable.
+ */
+void plotfx_set_font_cache(const char* path);
+
 /**
  * Retrieve the last error message. The returned pointer is valid until the next
  * `plotfx_*` method is called on the context.
@@ -103,11 +138,52 @@ int plotfx_configure_file(
 const char* plotfx_geterror(const plotfx_t* ctx);
 
 /**
- * Set a variable in the given PlotFX context.
+ * Retrieve a counter that was collected during the last render. Supported
+ * names are:
+ *
+ *   - "marks_drawn" and "marks_culled" (the number of point markers that were
+ *     skipped because they would not change the output)
+ *   - "csv_cache_hits" and "csv_cache_misses" (the number of `csv(...)`
+ *     references that were resolved from an already loaded file, and the
+ *     number of files that were loaded); the counters include earlier loads
+ *     of the configuration in the same context
+ *   - "binary_cache_hits" and "binary_cache_misses" (the same for
+ *     `binary(...)` references)
+ *   - "parse_errors" (the number of values in the loaded data files that are
+ *     not numbers, in columns that also contain numbers) and
+ *     "parse_errors:<column>" (the same for a single column)
+ *   - "document_loads" and "document_updates" (the number of times the
+ *     configuration was loaded, and the number of renders that updated the
+ *     loaded document in place after `plotfx_append_f64v`)
+ *
+ * @returns: The counter value or zero if the name is unknown
+ */
+size_t plotfx_getstat(const plotfx_t* ctx, const char* name);
+
+/**
+ * Retrieve the name of the n-th column with parse errors, i.e. a column of the
+ * loaded data files that contains numbers and other values. Use
+ * `plotfx_getstat(ctx, "parse_errors:<column>")` to get the number of values
+ * that are not numbers.
  *
- * NOTE: If you use this to override a variable that is also set in the
- * configuration file, the order in which you call the `plotfx_configure` and
- * `plotfx_setvar` methods is significant.
+ * @returns: The column name or nullptr if there are no more columns
+ */
+const char* plotfx_getstat_column(const plotfx_t* ctx, size_t index);
+
+/**
+ * Set a variable in the given PlotFX context. Variables can be referenced by
+ * name wherever the configuration expects a data series, e.g. `x: myvar;`.
+ *
+ * Variables set with `plotfx_setvar_*` take precedence over variables of the
+ * same name that are defined by the configuration (e.g. CSV columns loaded with
+ * `data: csv(...)`). Variables may be set before or after `plotfx_configure`;
+ * if a variable changes after the configuration was loaded, the document is
+ * rebuilt from the stored configuration on the next call to
+ * `plotfx_render_file`. Data files are not loaded again in that case.
+ *
+ * All `plotfx_setvar_*` methods except `plotfx_setvar_f64v_borrowed` copy the
+ * provided values. String values are parsed the same way as CSV cells, so a
+ * list of numeric strings becomes a numeric series.
  */
 void plotfx_setvar_f64(
     plotfx_t* ctx,
@@ -125,6 +201,54 @@ void plotfx_setvar_f64v(
     const double* values,
     size_t value_count);
 
+/**
+ * Set a variable in the given PlotFX context without copying the values. The
+ * context keeps a pointer to the caller's buffer instead.
+ *
+ * Lifetime rules:
+ *  - The buffer must stay valid until the variable has been replaced by
+ *    another `plotfx_setvar_*` call *and* the next `plotfx_configure` or
+ *    `plotfx_render_file` call has returned, or until the context is
+ *    destroyed with `plotfx_destroy`.
+ *  - The buffer must not be modified while a `plotfx_*` method is running.
+ *  - After modifying the buffer, call `plotfx_setvar_f64v_borrowed` again
+ *    (the pointer may be the same) before rendering, so that scales are
+ *    refitted to the new values.
+ */
+void plotfx_setvar_f64v_borrowed(
+    plotfx_t* ctx,
+    const char* name,
+    size_t name_len,
+    const double* values,
+    size_t value_count);
+
+/**
+ * Append values to a variable that was set with one of the `plotfx_setvar_*`
+ * methods. The values are copied; a borrowed variable is converted to an
+ * owned copy on the first append.
+ *
+ * This is meant for live charts: on the next render the loaded document is
+ * updated in place. The configuration is not parsed again, no data files are
+ * reloaded and the domains of scales, the groups and the colors of the layers
+ * are extended with the appended values only. The document is loaded again
+ * if it can't be updated, i.e. if the new values start a new group or if a
+ * layer has per-point 'colors' or 'sizes' or is of type 'bars' or 'labels'.
+ *
+ * Appended variables also keep their screen coordinates between renders, so
+ * only the new values are projected as long as the domain and the plot area
+ * are unchanged. If an automatically fitted domain grows because of the new
+ * values, all values are projected again.
+ *
+ * @returns: One (1) on success and zero (0) if an error has occured, e.g. if the
+ *   variable does not exist or contains text
+ */
+int plotfx_append_f64v(
+    plotfx_t* ctx,
+    const char* name,
+    size_t name_len,
+    const double* values,
+    size_t value_count);
+
 /**
  * Set a variable in the given PlotFX context.
  */
@@ -146,6 +270,20 @@ void plotfx_setvar_strv(
     const size_t* value_lens,
     size_t value_count);
 
+/**
+ * Write variables of the given PlotFX context to a file in the binary data
+ * format, so that it can later be read with `binary(<file>, <column>)`. Each
+ * variable is stored as a column of the same name.
+ *
+ * @returns: One (1) on success and zero (0) if an error has occured, e.g. if a
+ *   variable does not exist
+ */
+int plotfx_write_binary(
+    plotfx_t* ctx,
+    const char* path,
+    const char** names,
+    size_t name_count);
+
 #ifdef __cplusplus
 } // extern C
 #endif
@@ -49,12 +49,21 @@ int main(int argc, const char** argv) {
   std::string flag_in;
   flag_parser.defineString("in", false, &flag_in);
 
-  std::string flag_out;
-  flag_parser.defineString("out", false, &flag_out);
+  std::vector<std::string> flag_out;
+  flag_parser.defineStringList("out", false, &flag_out);
 
   std::string flag_out_fmt;
   flag_parser.defineString("outfmt", false, &flag_out_fmt);
 
+  uint64_t flag_threads = 1;
+  flag_parser.defineUInt64("threads", false, &flag_threads);
+
+  std::string flag_font_cache;
+  flag_parser.defineString("font-cache", false, &flag_font_cache);
+
+  bool flag_stats = false;
+  flag_parser.defineSwitch("stats", &flag_stats);
+
   bool flag_help = false;
   flag_parser.defineSwitch("help", &flag_help);
 
@@ -89,6 +98,14 @@ int main(int argc, const char** argv) {
         "Usage: $ plotfx [OPTIONS]\n"
         "   --help                Display this help text and exit\n"
         "   --version             Display the version of this binary and exit\n"
+        "   --in <file>           Read the chart configuration from this file\n"
+        "   --out <file>[:scale]  Write the chart to this file; may be given more than\n"
+        "                         once, e.g. --out a.svg --out thumb.png:0.25\n"
+        "   --outfmt <fmt>        Output format (svg or png) if not given by the filename\n"
+        "   --threads <n>         Number of threads used to load data and write the\n"
+        "                         outputs (0 = all cores)\n"
+        "   --font-cache <file>   Remember font lookups in this file\n"
+        "   --stats               Print render statistics after rendering\n"
         "\n"
         "Commands:\n";
 
@@ -107,10 +124,36 @@ int main(int argc, const char** argv) {
     return 1;
   }
 
-  std::string fmt = flag_out_fmt;
-  if (fmt.empty()) {
-    if (StringUtil::endsWith(flag_out, ".svg")) { fmt = "svg"; }
-    if (StringUtil::endsWith(flag_out, ".png")) { fmt = "png"; }
+  /* split off the optional scale suffix, e.g. thumb.png:0.25 */
+  std::vector<std::string> out_paths;
+  std::vector<double> out_scales;
+  for (const auto& out : flag_out) {
+    auto path = out;
+    auto scale = 1.0;
+
+    auto sep = out.rfind(':');
+    if (sep != std::string::npos && sep > 0 && sep + 1 < out.size()) {
+      char* end;
+      auto value = strtod(out.c_str() + sep + 1, &end);
+      if (*end == 0) {
+        path = out.substr(0, sep);
+        scale = value;
+      }
+    }
+
+    out_paths.emplace_back(path);
+    out_scales.emplace_back(scale);
+  }
+
+  std::vector<const char*> out_paths_c;
+  std::vector<const char*> out_formats_c;
+  for (const auto& path : out_paths) {
+    out_paths_c.emplace_back(path.c_str());
+    out_formats_c.emplace_back(flag_out_fmt.empty() ? nullptr : flag_out_fmt.c_str());
+  }
+
+  if (!flag_font_cache.empty()) {
+    plotfx_set_font_cache(flag_font_cache.c_str());
   }
 
   plotfx_t* ctx = plotfx_init();
@@ -119,6 +162,8 @@ int main(int argc, const char** argv) {
     return EXIT_FAILURE;
   }
 
+  plotfx_set_threads(ctx, flag_threads);
+
   if (!plotfx_configure_file(ctx, flag_in.c_str())) {
     std::cerr
         << "ERROR: error while parsing configuration: "
@@ -127,7 +172,14 @@ int main(int argc, const char** argv) {
     return EXIT_FAILURE;
   }
 
-  if (!plotfx_render_file(ctx, flag_out.c_str(), fmt.c_str())) {
+  auto rc = plotfx_render_files(
+      ctx,
+      out_paths_c.data(),
+      out_formats_c.data(),
+      out_scales.data(),
+      out_paths_c.size());
+
+  if (!rc) {
     std::cerr
         << "ERROR: error while rendering"
         << plotfx_geterror(ctx)
@@ -135,5 +187,30 @@ int main(int argc, const char** argv) {
     return EXIT_FAILURE;
   }
 
+  if (flag_stats) {
+    std::cerr
+        << StringUtil::format(
+              "marks drawn: $0\nmarks culled: $1\n"
+              "csv cache hits: $2\ncsv cache misses: $3\n"
+              "binary cache hits: $4\nbinary cache misses: $5",
+              plotfx_getstat(ctx, "marks_drawn"),
+              plotfx_getstat(ctx, "marks_culled"),
+              plotfx_getstat(ctx, "csv_cache_hits"),
+              plotfx_getstat(ctx, "csv_cache_misses"),
+              plotfx_getstat(ctx, "binary_cache_hits"),
+              plotfx_getstat(ctx, "binary_cache_misses"))
+        << std::endl;
+
+    for (size_t i = 0; plotfx_getstat_column(ctx, i); ++i) {
+      std::string column = plotfx_getstat_column(ctx, i);
+      std::cerr
+          << StringUtil::format(
+                "parse errors in column '$0': $1",
+                column,
+                plotfx_getstat(ctx, ("parse_errors:" + column).c_str()))
+          << std::endl;
+    }
+  }
+
   return EXIT_SUCCESS;
 }
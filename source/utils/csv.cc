@@ -21,23 +21,383 @@
  * commercial activities involving this program without disclosing the source
  * code of your own applications
  */
+#include <algorithm>
+#include <string.h>
 #include "csv.h"
+#include "parallel.h"
+
+/* the SSE2 tokenizer is always available if the compiler targets SSE2 (all
+   x86-64 and some i386 targets); AVX2 is detected at runtime */
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define PLOTFX_CSV_X86 1
+#include <immintrin.h>
+#endif
 
 namespace plotfx {
 
+static const size_t kCSVMinChunkSize = 1 << 20;
+
+CSVTable::CSVTable() :
+    data(nullptr),
+    size(0) {}
+
+struct CSVTokenizerState {
+  CSVTokenizerState() :
+      quoted(false),
+      escaped(false),
+      row_begin(0),
+      next(0) {}
+
+  bool quoted;
+  bool escaped;
+  size_t row_begin;
+  size_t next;
+};
+
+static inline void csv_tokenize_byte(
+    const CSVParserConfig& opts,
+    const char* data,
+    size_t i,
+    CSVTokenizerState* state,
+    CSVTable* table) {
+  auto byte = data[i];
+
+  if (byte == opts.escape_char) {
+    state->escaped = !state->escaped;
+    return;
+  }
+
+  if (!state->escaped && byte == opts.quote_char) {
+    state->quoted = !state->quoted;
+    return;
+  }
+
+  if (!state->quoted &&
+      (byte == opts.column_separator || byte == opts.line_separator)) {
+    table->field_ends.push_back(i);
+
+    if (byte == opts.line_separator) {
+      table->rows.push_back(state->row_begin);
+      state->row_begin = table->field_ends.size();
+    }
+  }
+
+  state->escaped = false;
+}
+
+static void csv_tokenize_range(
+    const CSVParserConfig& opts,
+    const char* data,
+    size_t begin,
+    size_t end,
+    CSVTokenizerState* state,
+    CSVTable* table) {
+  for (size_t i = begin; i < end; ++i) {
+    csv_tokenize_byte(opts, data, i, state, table);
+  }
+
+  state->next = end;
+}
+
+/**
+ * Process a block of input given a bitmask of the positions of all special
+ * (escape, quote, column and line separator) characters in the block. All
+ * other characters only reset the escape state, so they can be skipped.
+ */
+static inline void csv_tokenize_mask(
+    const CSVParserConfig& opts,
+    const char* data,
+    size_t base,
+    uint64_t mask,
+    CSVTokenizerState* state,
+    CSVTable* table) {
+  while (mask) {
+    auto pos = base + __builtin_ctzll(mask);
+    mask &= mask - 1;
+
+    if (pos > state->next) {
+      state->escaped = false;
+    }
+
+    csv_tokenize_byte(opts, data, pos, state, table);
+    state->next = pos + 1;
+  }
+}
+
+static ReturnCode csv_tokenize_finish(
+    size_t size,
+    CSVTokenizerState* state,
+    CSVTable* table) {
+  if (state->quoted) {
+    return ReturnCode::error("EIO", "invalid csv line");
+  }
+
+  /* the last line may not be terminated by a line separator. if it ends with
+     a column separator, its last field is empty */
+  size_t last_field = table->field_ends.empty()
+      ? 0
+      : table->field_ends.back() + 1;
+
+  bool mid_row = table->field_ends.size() > state->row_begin;
+  if (last_field < size || mid_row) {
+    table->field_ends.push_back(size);
+    table->rows.push_back(state->row_begin);
+    state->row_begin = table->field_ends.size();
+  }
+
+  table->rows.push_back(state->row_begin);
+  return ReturnCode::success();
+}
+
+static void csv_tokenize_scalar(
+    const CSVParserConfig& opts,
+    const char* data,
+    size_t begin,
+    size_t end,
+    CSVTokenizerState* state,
+    CSVTable* table) {
+  csv_tokenize_range(opts, data, begin, end, state, table);
+}
+
+#ifdef PLOTFX_CSV_X86
+
+static void csv_tokenize_sse2(
+    const CSVParserConfig& opts,
+    const char* data,
+    size_t begin,
+    size_t end,
+    CSVTokenizerState* state,
+    CSVTable* table) {
+  const auto escape_char = _mm_set1_epi8(opts.escape_char);
+  const auto quote_char = _mm_set1_epi8(opts.quote_char);
+  const auto column_separator = _mm_set1_epi8(opts.column_separator);
+  const auto line_separator = _mm_set1_epi8(opts.line_separator);
+
+  size_t i = begin;
+  for (; i + 64 <= end; i += 64) {
+    uint64_t mask = 0;
+    for (size_t j = 0; j < 4; ++j) {
+      auto v = _mm_loadu_si128((const __m128i*) (data + i + j * 16));
+      auto m = _mm_or_si128(
+          _mm_or_si128(
+              _mm_cmpeq_epi8(v, escape_char),
+              _mm_cmpeq_epi8(v, quote_char)),
+          _mm_or_si128(
+              _mm_cmpeq_epi8(v, column_separator),
+              _mm_cmpeq_epi8(v, line_separator)));
+
+      mask |= uint64_t(uint32_t(_mm_movemask_epi8(m))) << (j * 16);
+    }
+
+    csv_tokenize_mask(opts, data, i, mask, state, table);
+  }
+
+  if (i > state->next) {
+    state->escaped = false;
+  }
+
+  csv_tokenize_range(opts, data, i, end, state, table);
+}
+
+__attribute__((target("avx2")))
+static void csv_tokenize_avx2(
+    const CSVParserConfig& opts,
+    const char* data,
+    size_t begin,
+    size_t end,
+    CSVTokenizerState* state,
+    CSVTable* table) {
+  const auto escape_char = _mm256_set1_epi8(opts.escape_char);
+  const auto quote_char = _mm256_set1_epi8(opts.quote_char);
+  const auto column_separator = _mm256_set1_epi8(opts.column_separator);
+  const auto line_separator = _mm256_set1_epi8(opts.line_separator);
+
+  size_t i = begin;
+  for (; i + 64 <= end; i += 64) {
+    uint64_t mask = 0;
+    for (size_t j = 0; j < 2; ++j) {
+      auto v = _mm256_loadu_si256((const __m256i*) (data + i + j * 32));
+      auto m = _mm256_or_si256(
+          _mm256_or_si256(
+              _mm256_cmpeq_epi8(v, escape_char),
+              _mm256_cmpeq_epi8(v, quote_char)),
+          _mm256_or_si256(
+              _mm256_cmpeq_epi8(v, column_separator),
+              _mm256_cmpeq_epi8(v, line_separator)));
+
+      mask |= uint64_t(uint32_t(_mm256_movemask_epi8(m))) << (j * 32);
+    }
+
+    csv_tokenize_mask(opts, data, i, mask, state, table);
+  }
+
+  if (i > state->next) {
+    state->escaped = false;
+  }
+
+  csv_tokenize_range(opts, data, i, end, state, table);
+}
+
+#endif
+
+CSVTokenizer csv_tokenizer_resolve(CSVTokenizer tokenizer) {
+#ifdef PLOTFX_CSV_X86
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+
+  switch (tokenizer) {
+    case CSVTokenizer::AUTO:
+    case CSVTokenizer::AVX2:
+      return has_avx2 ? CSVTokenizer::AVX2 : CSVTokenizer::SSE2;
+    case CSVTokenizer::SSE2:
+      return CSVTokenizer::SSE2;
+    case CSVTokenizer::SCALAR:
+      return CSVTokenizer::SCALAR;
+  }
+#endif
+
+  return CSVTokenizer::SCALAR;
+}
+
+static void csv_tokenize(
+    CSVTokenizer tokenizer,
+    const CSVParserConfig& opts,
+    const char* data,
+    size_t begin,
+    size_t end,
+    CSVTokenizerState* state,
+    CSVTable* table) {
+  switch (tokenizer) {
+#ifdef PLOTFX_CSV_X86
+    case CSVTokenizer::AVX2:
+      return csv_tokenize_avx2(opts, data, begin, end, state, table);
+    case CSVTokenizer::SSE2:
+      return csv_tokenize_sse2(opts, data, begin, end, state, table);
+#endif
+    default:
+      return csv_tokenize_scalar(opts, data, begin, end, state, table);
+  }
+}
+
+/**
+ * Split the input into chunks that start after a line separator and tokenize
+ * them in parallel. Every chunk is tokenized on the assumption that it starts
+ * at the beginning of a row. When the chunks are joined, a chunk whose
+ * predecessor did not end at a row boundary (because the line separator was
+ * part of a quoted field) is tokenized again with the carried state.
+ */
+static void csv_tokenize_parallel(
+    CSVTokenizer tokenizer,
+    const CSVParserConfig& opts,
+    const char* data,
+    size_t size,
+    size_t chunk_count,
+    CSVTokenizerState* state,
+    CSVTable* table) {
+  std::vector<size_t> bounds(chunk_count + 1, size);
+  bounds[0] = 0;
+  for (size_t i = 1; i < chunk_count; ++i) {
+    auto pos = std::max(size / chunk_count * i, bounds[i - 1]);
+    auto sep = (const char*) memchr(data + pos, opts.line_separator, size - pos);
+    bounds[i] = sep ? sep - data + 1 : size;
+  }
+
+  std::vector<CSVTable> chunks(chunk_count);
+  std::vector<CSVTokenizerState> chunk_states(chunk_count);
+  parallel_for(chunk_count, opts.threads, [&] (size_t i) {
+    chunk_states[i].next = bounds[i];
+    csv_tokenize(
+        tokenizer,
+        opts,
+        data,
+        bounds[i],
+        bounds[i + 1],
+        &chunk_states[i],
+        &chunks[i]);
+  });
+
+  for (size_t i = 0; i < chunk_count; ++i) {
+    auto field_offset = table->field_ends.size();
+    if (state->quoted || state->escaped || state->row_begin != field_offset) {
+      csv_tokenize(
+          tokenizer,
+          opts,
+          data,
+          bounds[i],
+          bounds[i + 1],
+          state,
+          table);
+
+      continue;
+    }
+
+    const auto& chunk = chunks[i];
+    table->field_ends.insert(
+        table->field_ends.end(),
+        chunk.field_ends.begin(),
+        chunk.field_ends.end());
+
+    for (auto row : chunk.rows) {
+      table->rows.push_back(row + field_offset);
+    }
+
+    state->quoted = chunk_states[i].quoted;
+    state->escaped = chunk_states[i].escaped;
+    state->row_begin = chunk_states[i].row_begin + field_offset;
+    state->next = bounds[i + 1];
+  }
+}
+
 ReturnCode parseCSV(
-    std::string input,
+    const char* data,
+    size_t size,
     const CSVParserConfig& opts,
-    std::list<std::vector<std::string>>* output) {
-  input.push_back(0);
+    CSVTable* table) {
+  table->data = data;
+  table->size = size;
+  table->config = opts;
+  table->field_ends.clear();
+  table->rows.clear();
+
+  auto tokenizer = csv_tokenizer_resolve(opts.tokenizer);
+  auto chunk_count = std::min(
+      parallel_thread_count(opts.threads),
+      size / kCSVMinChunkSize);
+
+  CSVTokenizerState state;
+  if (chunk_count > 1) {
+    csv_tokenize_parallel(
+        tokenizer,
+        opts,
+        data,
+        size,
+        chunk_count,
+        &state,
+        table);
+  } else {
+    csv_tokenize(tokenizer, opts, data, 0, size, &state, table);
+  }
+
+  return csv_tokenize_finish(size, &state, table);
+}
+
+size_t csv_row_count(const CSVTable& table) {
+  return table.rows.empty() ? 0 : table.rows.size() - 1;
+}
+
+size_t csv_column_count(const CSVTable& table, size_t row) {
+  return table.rows[row + 1] - table.rows[row];
+}
 
-  std::vector<std::string> row;
+static std::string csv_unescape(
+    const CSVParserConfig& opts,
+    const char* begin,
+    const char* end) {
   std::string buffer;
-  bool quoted = false;
   bool escaped = false;
-  size_t row_index = 0;
 
-  for (const auto& byte : input) {
+  for (auto cur = begin; cur != end; ++cur) {
+    auto byte = *cur;
+
     if (byte == opts.escape_char) {
       if (escaped) {
         buffer += opts.escape_char;
@@ -49,22 +409,6 @@ ReturnCode parseCSV(
     }
 
     if (!escaped && byte == opts.quote_char) {
-      quoted = !quoted;
-      continue;
-    }
-
-    if ((!quoted && byte == opts.column_separator) ||
-        (!quoted && byte == opts.line_separator) ||
-        (!quoted && byte == 0)) {
-      row.emplace_back(buffer);
-      buffer.clear();
-
-      if (byte == opts.line_separator) {
-        ++row_index;
-        output->push_back(row);
-        row.clear();
-      }
-
       continue;
     }
 
@@ -72,13 +416,28 @@ ReturnCode parseCSV(
     escaped = false;
   }
 
-  if (quoted || buffer.size() > 0) {
-    return ReturnCode::error("EIO", "invalid csv line");
+  return buffer;
+}
+
+std::string_view csv_cell(
+    const CSVTable& table,
+    size_t row,
+    size_t column,
+    std::deque<std::string>* unescaped) {
+  auto field = table.rows[row] + column;
+  auto begin = field > 0 ? table.field_ends[field - 1] + 1 : 0;
+  auto end = table.field_ends[field];
+  auto cell = std::string_view(table.data + begin, end - begin);
+
+  const auto& opts = table.config;
+  if (cell.find(opts.quote_char) == std::string_view::npos &&
+      cell.find(opts.escape_char) == std::string_view::npos) {
+    return cell;
   }
 
-  return ReturnCode::success();
+  unescaped->emplace_back(csv_unescape(opts, cell.data(), cell.data() + cell.size()));
+  return unescaped->back();
 }
 
 } // namespace plotfx
 
-
@@ -22,31 +22,82 @@
  * code of your own applications
  */
 #pragma once
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "utils/return_code.h"
 
 namespace plotfx {
 
+/**
+ * The tokenizer implementation used to find the field boundaries. AUTO picks
+ * the fastest implementation supported by the CPU at runtime; requesting an
+ * unsupported implementation falls back to the next best one.
+ */
+enum class CSVTokenizer {
+  AUTO, SCALAR, SSE2, AVX2
+};
+
 struct CSVParserConfig {
   CSVParserConfig() :
       line_separator('\n'),
       column_separator(','),
       quote_char('\"'),
-      escape_char('\\') {}
+      escape_char('\\'),
+      tokenizer(CSVTokenizer::AUTO),
+      threads(1) {}
 
   char line_separator;
   char column_separator;
   char quote_char;
   char escape_char;
+  CSVTokenizer tokenizer;
+
+  /**
+   * The number of threads used to tokenize large inputs; zero means one
+   * thread per core
+   */
+  size_t threads;
+};
+
+/**
+ * A parsed CSV table that references the input data without copying it. The
+ * parser only records the offset at which each field ends; cells are returned
+ * as views into the input and are only unescaped (copied) on access if they
+ * contain quote or escape characters. The input data must outlive the table.
+ */
+struct CSVTable {
+  CSVTable();
+  const char* data;
+  size_t size;
+  CSVParserConfig config;
+  std::vector<size_t> field_ends;
+  std::vector<size_t> rows;
 };
 
-using CSVData = std::list<std::vector<std::string>>;
+CSVTokenizer csv_tokenizer_resolve(CSVTokenizer tokenizer);
 
 ReturnCode parseCSV(
-    std::string input,
+    const char* data,
+    size_t size,
     const CSVParserConfig& config,
-    CSVData* output);
+    CSVTable* table);
+
+size_t csv_row_count(const CSVTable& table);
+
+size_t csv_column_count(const CSVTable& table, size_t row);
+
+/**
+ * Return the cell at the given position. Cells that contain quote or escape
+ * characters are unescaped into a new string that is appended to `unescaped`,
+ * all other cells are returned as a view into the input data.
+ */
+std::string_view csv_cell(
+    const CSVTable& table,
+    size_t row,
+    size_t column,
+    std::deque<std::string>* unescaped);
 
 } // namespace plotfx
 
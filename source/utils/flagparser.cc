@@ -50,6 +50,19 @@ void FlagParser::defineString(
   flags_.emplace_back(flag_state);
 }
 
+void FlagParser::defineStringList(
+    const char* longopt,
+    bool required,
+    std::vector<std::string>* values) {
+  FlagState flag_state;
+  flag_state.type = T_STRING_LIST;
+  flag_state.required = required;
+  flag_state.longopt = longopt;
+  flag_state.value = static_cast<void*>(values);
+  flag_state.has_value = false;
+  flags_.emplace_back(flag_state);
+}
+
 void FlagParser::defineSwitch(
     const char* longopt,
     bool* value) {
@@ -107,6 +120,10 @@ ReturnCode parseValue(FlagState* flag, const std::string& value) {
       *static_cast<std::string*>(flag->value) = value;
       break;
 
+    case T_STRING_LIST:
+      static_cast<std::vector<std::string>*>(flag->value)->emplace_back(value);
+      break;
+
     case T_SWITCH:
       if (value == "on") {
         *static_cast<bool*>(flag->value) = true;
@@ -38,6 +38,7 @@ namespace plotfx {
 enum kFlagType {
   T_SWITCH,
   T_STRING,
+  T_STRING_LIST,
   T_INT64,
   T_UINT64,
   T_FLOAT64,
@@ -65,6 +66,15 @@ public:
       bool required,
       std::string* value);
 
+  /**
+   * Define a string flag that may be given more than once. Each value is
+   * appended to the list
+   */
+  void defineStringList(
+      const char* longopt,
+      bool required,
+      std::vector<std::string>* values);
+
   /**
    * Define a boolean flag
    */
@@ -0,0 +1,85 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <functional>
+#include <list>
+#include <stdlib.h>
+#include <unordered_map>
+
+namespace plotfx {
+
+struct CacheStats {
+  CacheStats();
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+};
+
+/**
+ * A map that holds up to `capacity` entries and evicts the least recently
+ * used entry when a new one is inserted into a full cache. Not thread safe
+ */
+template <typename K, typename V, typename H = std::hash<K>>
+class LRUCache {
+public:
+
+  explicit LRUCache(size_t capacity);
+
+  /**
+   * Returns a pointer to the cached value or nullptr if the key is not in the
+   * cache. The pointer is valid until the next call to `put` or `clear`
+   */
+  V* get(const K& key);
+
+  void put(K key, V value);
+
+  void setCapacity(size_t capacity);
+  size_t getCapacity() const;
+
+  size_t size() const;
+  const CacheStats& getStats() const;
+
+  void clear();
+
+protected:
+
+  void evict(size_t capacity);
+
+  using EntryList = std::list<std::pair<K, V>>;
+
+  size_t capacity_;
+  EntryList entries_;
+  std::unordered_map<K, typename EntryList::iterator, H> index_;
+  CacheStats stats_;
+};
+
+} // namespace plotfx
+
+#include "lru_cache_impl.h"
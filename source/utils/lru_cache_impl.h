@@ -0,0 +1,105 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+namespace plotfx {
+
+inline CacheStats::CacheStats() :
+    hits(0),
+    misses(0),
+    evictions(0) {}
+
+template <typename K, typename V, typename H>
+LRUCache<K, V, H>::LRUCache(size_t capacity) : capacity_(capacity) {}
+
+template <typename K, typename V, typename H>
+V* LRUCache<K, V, H>::get(const K& key) {
+  auto iter = index_.find(key);
+  if (iter == index_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+
+  entries_.splice(entries_.begin(), entries_, iter->second);
+  ++stats_.hits;
+  return &iter->second->second;
+}
+
+template <typename K, typename V, typename H>
+void LRUCache<K, V, H>::put(K key, V value) {
+  if (auto iter = index_.find(key); iter != index_.end()) {
+    iter->second->second = std::move(value);
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return;
+  }
+
+  entries_.emplace_front(std::move(key), std::move(value));
+  index_.emplace(entries_.front().first, entries_.begin());
+  evict(capacity_);
+}
+
+template <typename K, typename V, typename H>
+void LRUCache<K, V, H>::evict(size_t capacity) {
+  while (entries_.size() > capacity) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+    ++stats_.evictions;
+  }
+}
+
+template <typename K, typename V, typename H>
+void LRUCache<K, V, H>::setCapacity(size_t capacity) {
+  capacity_ = capacity;
+  evict(capacity_);
+}
+
+template <typename K, typename V, typename H>
+size_t LRUCache<K, V, H>::getCapacity() const {
+  return capacity_;
+}
+
+template <typename K, typename V, typename H>
+size_t LRUCache<K, V, H>::size() const {
+  return entries_.size();
+}
+
+template <typename K, typename V, typename H>
+const CacheStats& LRUCache<K, V, H>::getStats() const {
+  return stats_;
+}
+
+template <typename K, typename V, typename H>
+void LRUCache<K, V, H>::clear() {
+  index_.clear();
+  entries_.clear();
+}
+
+} // namespace plotfx
+
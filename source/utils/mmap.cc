@@ -0,0 +1,94 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mmap.h"
+
+namespace plotfx {
+
+MappedFile::MappedFile() :
+    data(nullptr),
+    size(0) {}
+
+MappedFile::~MappedFile() {
+  if (data) {
+    munmap((void*) data, size);
+  }
+}
+
+ReturnCode mmap_file(
+    const std::string& path,
+    MappedFileRef* file) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return ReturnCode::errorf(
+        "EIO",
+        "unable to open file '$0': $1",
+        path,
+        strerror(errno));
+  }
+
+  struct stat fd_stat;
+  if (fstat(fd, &fd_stat) < 0) {
+    close(fd);
+    return ReturnCode::errorf(
+        "EIO",
+        "fstat('$0') failed: $1",
+        path,
+        strerror(errno));
+  }
+
+  auto mapping = std::make_shared<MappedFile>();
+  if (fd_stat.st_size > 0) {
+    auto data = mmap(nullptr, fd_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return ReturnCode::errorf(
+          "EIO",
+          "mmap('$0') failed: $1",
+          path,
+          strerror(errno));
+    }
+
+    madvise(data, fd_stat.st_size, MADV_SEQUENTIAL);
+    mapping->data = static_cast<const char*>(data);
+    mapping->size = fd_stat.st_size;
+  }
+
+  close(fd);
+  *file = mapping;
+  return OK;
+}
+
+} // namespace plotfx
+
@@ -0,0 +1,79 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "parallel.h"
+
+namespace plotfx {
+
+size_t parallel_thread_count(size_t threads) {
+  if (threads > 0) {
+    return threads;
+  }
+
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void parallel_for(
+    size_t task_count,
+    size_t threads,
+    const std::function<void (size_t)>& fn) {
+  auto worker_count = std::min(parallel_thread_count(threads), task_count);
+  if (worker_count <= 1) {
+    for (size_t i = 0; i < task_count; ++i) {
+      fn(i);
+    }
+
+    return;
+  }
+
+  std::atomic<size_t> next_task(0);
+  auto worker = [&] {
+    for (size_t i; (i = next_task++) < task_count; ) {
+      fn(i);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < worker_count; ++i) {
+    workers.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto& t : workers) {
+    t.join();
+  }
+}
+
+} // namespace plotfx
+
@@ -0,0 +1,266 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include <list>
+#include <random>
+#include "utils/csv.h"
+#include "utils/fileutil.h"
+#include "utils/flagparser.h"
+#include "utils/mmap.h"
+#include "utils/stringutil.h"
+#include "utils/wallclock.h"
+
+using namespace plotfx;
+
+static const size_t kRuns = 3;
+
+/**
+ * The original byte-at-a-time parser that copies every field into a string,
+ * kept as a baseline for the tokenizer
+ */
+ReturnCode parseCSVBaseline(
+    std::string input,
+    const CSVParserConfig& opts,
+    std::list<std::vector<std::string>>* output) {
+  input.push_back(0);
+
+  std::vector<std::string> row;
+  std::string buffer;
+  bool quoted = false;
+  bool escaped = false;
+
+  for (const auto& byte : input) {
+    if (byte == opts.escape_char) {
+      if (escaped) {
+        buffer += opts.escape_char;
+        escaped = false;
+      } else {
+        escaped = true;
+      }
+      continue;
+    }
+
+    if (!escaped && byte == opts.quote_char) {
+      quoted = !quoted;
+      continue;
+    }
+
+    if ((!quoted && byte == opts.column_separator) ||
+        (!quoted && byte == opts.line_separator) ||
+        (!quoted && byte == 0)) {
+      row.emplace_back(buffer);
+      buffer.clear();
+
+      if (byte == opts.line_separator) {
+        output->push_back(row);
+        row.clear();
+      }
+
+      continue;
+    }
+
+    buffer += byte;
+    escaped = false;
+  }
+
+  if (quoted || buffer.size() > 0) {
+    return ReturnCode::error("EIO", "invalid csv line");
+  }
+
+  return ReturnCode::success();
+}
+
+/**
+ * Time the baseline parser on the given input and return the best throughput
+ * of kRuns runs in MB/s
+ */
+double bench_baseline(
+    const char* data,
+    size_t size,
+    size_t* field_count) {
+  uint64_t best = 0;
+  for (size_t i = 0; i < kRuns; ++i) {
+    std::list<std::vector<std::string>> rows;
+    auto t0 = MonotonicClock::now();
+    if (!parseCSVBaseline(std::string(data, size), CSVParserConfig{}, &rows)) {
+      std::cerr << "ERROR: parseCSVBaseline failed" << std::endl;
+      std::exit(1);
+    }
+
+    auto t = MonotonicClock::now() - t0;
+    if (i == 0 || t < best) {
+      best = t;
+    }
+
+    *field_count = 0;
+    for (const auto& row : rows) {
+      *field_count += row.size();
+    }
+  }
+
+  return (size / 1048576.0) / (std::max(best, uint64_t(1)) / 1000000.0);
+}
+
+/**
+ * Time the tokenizer on the given input and return the best throughput of
+ * kRuns runs in MB/s
+ */
+double bench_tokenizer(
+    const char* data,
+    size_t size,
+    CSVTokenizer tokenizer,
+    size_t* field_count) {
+  CSVParserConfig opts;
+  opts.tokenizer = tokenizer;
+
+  uint64_t best = 0;
+  for (size_t i = 0; i < kRuns; ++i) {
+    CSVTable table;
+    auto t0 = MonotonicClock::now();
+    if (!parseCSV(data, size, opts, &table)) {
+      std::cerr << "ERROR: parseCSV failed" << std::endl;
+      std::exit(1);
+    }
+
+    auto t = MonotonicClock::now() - t0;
+    if (i == 0 || t < best) {
+      best = t;
+    }
+
+    *field_count = table.field_ends.size();
+  }
+
+  return (size / 1048576.0) / (std::max(best, uint64_t(1)) / 1000000.0);
+}
+
+void bench_input(
+    const std::string& name,
+    const char* data,
+    size_t size) {
+  static const std::vector<std::pair<std::string, CSVTokenizer>> tokenizers = {
+    { "scalar", CSVTokenizer::SCALAR },
+    { "sse2", CSVTokenizer::SSE2 },
+    { "avx2", CSVTokenizer::AVX2 },
+  };
+
+  {
+    size_t field_count;
+    auto mbps = bench_baseline(data, size, &field_count);
+    std::cout
+        << StringUtil::format(
+              "$0 [baseline]: $1 bytes, $2 fields, $3 MB/s",
+              name,
+              size,
+              field_count,
+              uint64_t(mbps))
+        << std::endl;
+  }
+
+  for (const auto& t : tokenizers) {
+    if (csv_tokenizer_resolve(t.second) != t.second) {
+      continue;
+    }
+
+    size_t field_count;
+    auto mbps = bench_tokenizer(data, size, t.second, &field_count);
+    std::cout
+        << StringUtil::format(
+              "$0 [$1]: $2 bytes, $3 fields, $4 MB/s",
+              name,
+              t.first,
+              size,
+              field_count,
+              uint64_t(mbps))
+        << std::endl;
+  }
+}
+
+/**
+ * Generate a synthetic time series CSV file with a timestamp, two numeric
+ * columns and a quoted text column
+ */
+std::string generate_synthetic(size_t size) {
+  std::mt19937_64 rng(1);
+  std::string data = "time,value,ratio,label\n";
+  data.reserve(size + 128);
+
+  for (uint64_t t = 1400000000; data.size() < size; ++t) {
+    data += std::to_string(t);
+    data += ',';
+    data += std::to_string(rng() % 100000);
+    data += ',';
+    data += std::to_string((rng() % 1000000) / 1000000.0);
+    data += (t % 16) ? ",host\n" : ",\"host, \\\"other\\\"\"\n";
+  }
+
+  return data;
+}
+
+int main(int argc, const char** argv) {
+  FlagParser flag_parser;
+
+  std::string flag_testdata = "tests/testdata";
+  flag_parser.defineString("testdata", false, &flag_testdata);
+
+  uint64_t flag_synthetic_mb = 1024;
+  flag_parser.defineUInt64("synthetic-mb", false, &flag_synthetic_mb);
+
+  if (auto rc = flag_parser.parseArgv(argc - 1, argv + 1); !rc) {
+    std::cerr << "ERROR: " << rc.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (FileUtil::exists(flag_testdata)) {
+    FileUtil::ls(flag_testdata, [&] (const std::string& file) {
+      if (!StringUtil::endsWith(file, ".csv")) {
+        return true;
+      }
+
+      auto path = FileUtil::joinPaths(flag_testdata, file);
+      MappedFileRef mapping;
+      if (auto rc = mmap_file(path, &mapping); !rc) {
+        std::cerr << "ERROR: " << rc.getMessage() << std::endl;
+        return true;
+      }
+
+      bench_input(file, mapping->data, mapping->size);
+      return true;
+    });
+  }
+
+  if (flag_synthetic_mb > 0) {
+    auto data = generate_synthetic(flag_synthetic_mb * 1048576);
+    bench_input("synthetic", data.data(), data.size());
+  }
+
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,152 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include <random>
+#include "graphics/display_list.h"
+#include "graphics/brush.h"
+#include "utils/flagparser.h"
+#include "utils/stringutil.h"
+#include "utils/wallclock.h"
+
+using namespace plotfx;
+
+static const size_t kRuns = 3;
+
+/**
+ * Run the function kRuns times and return the best run time in milliseconds
+ */
+template <typename F>
+double bench(F fn) {
+  uint64_t best = 0;
+  for (size_t i = 0; i < kRuns; ++i) {
+    auto t0 = MonotonicClock::now();
+    fn();
+    auto t = MonotonicClock::now() - t0;
+    if (i == 0 || t < best) {
+      best = t;
+    }
+  }
+
+  return best / 1000.0;
+}
+
+void report(const std::string& name, size_t count, double ms) {
+  std::cout
+      << StringUtil::format(
+            "$0: $1 points in $2ms ($3k points/s)",
+            name,
+            count,
+            ms,
+            uint64_t(count / std::max(ms, 0.001)))
+      << std::endl;
+}
+
+int main(int argc, const char** argv) {
+  FlagParser flag_parser;
+
+  uint64_t flag_count = 1000000;
+  flag_parser.defineUInt64("count", false, &flag_count);
+
+  if (auto rc = flag_parser.parseArgv(argc - 1, argv + 1); !rc) {
+    std::cerr << "ERROR: " << rc.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const double width = 1200;
+  const double height = 480;
+  const double radius = 4;
+
+  std::mt19937_64 rng(1);
+  std::normal_distribution<double> dist_y(height / 2, height / 8);
+
+  /* one long polyline and a marker batch with the same points */
+  layer_ops::BrushStrokeOp line;
+  line.clip = Rectangle(0, 0, width, height);
+  line.path.reserve(flag_count);
+
+  layer_ops::BrushFillBatchOp markers;
+  markers.clip = line.clip;
+  markers.path.reserve(flag_count * 2);
+
+  for (size_t i = 0; i < flag_count; ++i) {
+    auto x = width * i / flag_count;
+    auto y = dist_y(rng);
+
+    if (i == 0) {
+      line.path.moveTo(x, y);
+    } else {
+      line.path.lineTo(x, y);
+    }
+
+    markers.shapes.push_back(markers.path.size());
+    markers.path.moveTo(x + radius, y);
+    markers.path.arcTo(x, y, radius, 0, M_PI * 2);
+  }
+
+  DisplayList list;
+  report("display_list/record", flag_count, bench([&] {
+    list = DisplayList{};
+    LayerRef recorder;
+    layer_bind_recorder(width, height, 96, Measure(11), &list, &recorder);
+    recorder->apply(line);
+    recorder->apply(markers);
+  }));
+
+  std::cout
+      << StringUtil::format(
+            "display_list/size: $0 ops in $1 bytes",
+            list.op_count,
+            list.data.size())
+      << std::endl;
+
+  report("display_list/replay", flag_count, bench([&] {
+    size_t commands = 0;
+    display_list_visit(list, [&commands] (const layer_ops::Op& op) {
+      if (auto o = std::get_if<layer_ops::BrushStrokeOp>(&op); o) {
+        commands += o->path.size();
+      }
+
+      if (auto o = std::get_if<layer_ops::BrushFillBatchOp>(&op); o) {
+        commands += o->path.size();
+      }
+
+      return OK;
+    });
+
+    if (commands != flag_count * 3) {
+      std::cerr << "ERROR: replay returned the wrong number of commands" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }));
+
+  return EXIT_SUCCESS;
+}
+
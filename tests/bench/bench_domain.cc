@@ -0,0 +1,183 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include <random>
+#include "source/data_model.h"
+#include "source/domain.h"
+#include "utils/flagparser.h"
+#include "utils/stringutil.h"
+#include "utils/wallclock.h"
+
+using namespace plotfx;
+
+static const size_t kRuns = 5;
+
+/**
+ * Run the function kRuns times and return the best run time in milliseconds
+ */
+template <typename F>
+double bench(F fn) {
+  uint64_t best = 0;
+  for (size_t i = 0; i < kRuns; ++i) {
+    auto t0 = MonotonicClock::now();
+    fn();
+    auto t = MonotonicClock::now() - t0;
+    if (i == 0 || t < best) {
+      best = t;
+    }
+  }
+
+  return best / 1000.0;
+}
+
+void report(const std::string& name, size_t count, double ms) {
+  std::cout
+      << StringUtil::format(
+            "$0: $1 values in $2ms ($3M values/s)",
+            name,
+            count,
+            ms,
+            uint64_t(count / std::max(ms, 0.001) / 1000.0))
+      << std::endl;
+}
+
+/* the per-value fit loop that was used before series summaries */
+void fit_scalar(const Series& s, DomainConfig* domain) {
+  auto values = series_f64(s);
+  for (size_t i = 0; i < s.length; ++i) {
+    if (!series_is_valid(s, i)) {
+      continue;
+    }
+
+    double d = values[i];
+    if (!domain->min_auto || *domain->min_auto > d) {
+      domain->min_auto = std::optional<double>(d);
+    }
+    if (!domain->max_auto || *domain->max_auto < d) {
+      domain->max_auto = std::optional<double>(d);
+    }
+  }
+}
+
+/* translate into the unit range, then map to the screen in a second loop */
+std::vector<double> project_twopass(
+    const DomainConfig& domain,
+    const Series& s,
+    double origin,
+    double extent) {
+  auto translated = domain_translate(domain, s);
+  for (auto& v : translated) {
+    v = origin + (1.0 - v) * extent;
+  }
+
+  return translated;
+}
+
+bool bench_project(
+    const std::string& name,
+    const DomainConfig& domain,
+    const Series& s) {
+  std::vector<double> twopass;
+  report("project/" + name + "/twopass", s.length, bench([&] {
+    twopass = project_twopass(domain, s, 20, 400);
+  }));
+
+  std::vector<double> fused;
+  report("project/" + name + "/fused", s.length, bench([&] {
+    fused = domain_project(domain, s, 20, 400, true);
+  }));
+
+  return fused == twopass;
+}
+
+int main(int argc, const char** argv) {
+  FlagParser flag_parser;
+
+  uint64_t flag_count = 10000000;
+  flag_parser.defineUInt64("count", false, &flag_count);
+
+  if (auto rc = flag_parser.parseArgv(argc - 1, argv + 1); !rc) {
+    std::cerr << "ERROR: " << rc.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937_64 rng(1);
+  std::uniform_real_distribution<double> dist(-1000, 1000);
+  std::vector<double> values(flag_count);
+  for (auto& v : values) {
+    v = dist(rng);
+  }
+
+  auto series = series_from_float(values);
+
+  DomainConfig domain_scalar;
+  report("fit/scalar", flag_count, bench([&] {
+    domain_scalar = DomainConfig{};
+    fit_scalar(series, &domain_scalar);
+  }));
+
+  DomainConfig domain;
+  report("fit/summary", flag_count, bench([&] {
+    series.summary = SeriesSummary{};
+    domain = DomainConfig{};
+    domain_fit(series, &domain);
+  }));
+
+  report("fit/memoized", flag_count, bench([&] {
+    domain = DomainConfig{};
+    domain_fit(series, &domain);
+  }));
+
+  if (domain.min_auto != domain_scalar.min_auto ||
+      domain.max_auto != domain_scalar.max_auto) {
+    std::cerr << "ERROR: results differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  DomainConfig domain_linear = domain;
+  domain_linear.kind = DomainKind::LINEAR;
+
+  DomainConfig domain_inverted = domain_linear;
+  domain_inverted.inverted = true;
+
+  DomainConfig domain_log = domain_linear;
+  domain_log.kind = DomainKind::LOGARITHMIC;
+
+  if (!bench_project("linear", domain_linear, series) ||
+      !bench_project("inverted", domain_inverted, series) ||
+      !bench_project("log", domain_log, series)) {
+    std::cerr << "ERROR: results differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,145 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include <random>
+#include "graphics/rasterize.h"
+#include "utils/flagparser.h"
+#include "utils/stringutil.h"
+#include "utils/wallclock.h"
+
+using namespace plotfx;
+
+static const size_t kRuns = 3;
+
+/**
+ * Run the function kRuns times and return the best run time in milliseconds
+ */
+template <typename F>
+double bench(F fn) {
+  uint64_t best = 0;
+  for (size_t i = 0; i < kRuns; ++i) {
+    auto t0 = MonotonicClock::now();
+    fn();
+    auto t = MonotonicClock::now() - t0;
+    if (i == 0 || t < best) {
+      best = t;
+    }
+  }
+
+  return best / 1000.0;
+}
+
+void report(const std::string& name, size_t count, double ms) {
+  std::cout
+      << StringUtil::format(
+            "$0: $1 markers in $2ms ($3k markers/s)",
+            name,
+            count,
+            ms,
+            uint64_t(count / std::max(ms, 0.001)))
+      << std::endl;
+}
+
+int main(int argc, const char** argv) {
+  FlagParser flag_parser;
+
+  uint64_t flag_count = 1000000;
+  flag_parser.defineUInt64("count", false, &flag_count);
+
+  if (auto rc = flag_parser.parseArgv(argc - 1, argv + 1); !rc) {
+    std::cerr << "ERROR: " << rc.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const double width = 1200;
+  const double height = 480;
+  const double radius = 4;
+
+  std::mt19937_64 rng(1);
+  std::normal_distribution<double> dist_x(width / 2, width / 8);
+  std::normal_distribution<double> dist_y(height / 2, height / 8);
+
+  std::vector<double> xs(flag_count);
+  std::vector<double> ys(flag_count);
+  for (size_t i = 0; i < flag_count; ++i) {
+    xs[i] = dist_x(rng);
+    ys[i] = dist_y(rng);
+  }
+
+  layer_ops::BrushFillBatchOp batch;
+  batch.clip = Rectangle(0, 0, width, height);
+  batch.style.color = Color::fromRGB(0.2, 0.4, 0.8);
+  for (size_t i = 0; i < flag_count; ++i) {
+    batch.shapes.push_back(batch.path.size());
+    batch.path.moveTo(xs[i] + radius, ys[i]);
+    batch.path.arcTo(xs[i], ys[i], radius, 0, M_PI * 2);
+  }
+
+  auto text_shaper = std::make_shared<text::TextShaper>();
+
+  /* one cairo fill per marker, as submitted by separate BrushFillOps */
+  report("markers/path", flag_count, bench([&] {
+    Rasterizer raster(width, height, 96, text_shaper);
+    for (size_t i = 0; i < flag_count; ++i) {
+      layer_ops::BrushFillOp op;
+      op.clip = batch.clip;
+      op.path.moveTo(xs[i] + radius, ys[i]);
+      op.path.arcTo(xs[i], ys[i], radius, 0, M_PI * 2);
+      op.style = batch.style;
+      raster.fillPath(op);
+    }
+  }));
+
+  /* the same markers stamped from the sprite cache */
+  report("markers/sprite", flag_count, bench([&] {
+    Rasterizer raster(width, height, 96, text_shaper);
+    raster.fillPaths(batch);
+  }));
+
+  /* markers with a different radius each, as drawn for a `sizes` column */
+  layer_ops::BrushFillBatchOp batch_sizes;
+  batch_sizes.clip = batch.clip;
+  batch_sizes.style = batch.style;
+  for (size_t i = 0; i < flag_count; ++i) {
+    auto r = radius * (0.5 + double(i) / flag_count);
+    batch_sizes.shapes.push_back(batch_sizes.path.size());
+    batch_sizes.path.moveTo(xs[i] + r, ys[i]);
+    batch_sizes.path.arcTo(xs[i], ys[i], r, 0, M_PI * 2);
+  }
+
+  report("markers/sprite_sizes", flag_count, bench([&] {
+    Rasterizer raster(width, height, 96, text_shaper);
+    raster.fillPaths(batch_sizes);
+  }));
+
+  return EXIT_SUCCESS;
+}
+
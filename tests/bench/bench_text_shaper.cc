@@ -0,0 +1,142 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include <random>
+#include "graphics/font_lookup.h"
+#include "graphics/text_shaper.h"
+#include "utils/flagparser.h"
+#include "utils/stringutil.h"
+#include "utils/wallclock.h"
+
+using namespace plotfx;
+using namespace plotfx::text;
+
+static const size_t kRuns = 3;
+
+/**
+ * Run the function kRuns times and return the best run time in milliseconds
+ */
+template <typename F>
+double bench(F fn) {
+  uint64_t best = 0;
+  for (size_t i = 0; i < kRuns; ++i) {
+    auto t0 = MonotonicClock::now();
+    fn();
+    auto t = MonotonicClock::now() - t0;
+    if (i == 0 || t < best) {
+      best = t;
+    }
+  }
+
+  return best / 1000.0;
+}
+
+void report(const std::string& name, size_t count, double ms) {
+  std::cout
+      << StringUtil::format(
+            "$0: $1 labels in $2ms ($3k labels/s)",
+            name,
+            count,
+            ms,
+            uint64_t(count / std::max(ms, 0.001)))
+      << std::endl;
+}
+
+void bench_shaper(
+    const std::string& name,
+    const std::vector<std::string>& labels,
+    const FontInfo& font,
+    bool simple_shaping) {
+  TextShaper shaper;
+  shaper.setSimpleShaping(simple_shaping);
+
+  report(name, labels.size(), bench([&] {
+    for (const auto& label : labels) {
+      ShapedRunRef run;
+      if (!shaper.shapeRun(label, font, 14.666667, 96, &run)) {
+        std::cerr << "ERROR: unable to shape text" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+  }));
+}
+
+int main(int argc, const char** argv) {
+  FlagParser flag_parser;
+
+  uint64_t flag_count = 100000;
+  flag_parser.defineUInt64("count", false, &flag_count);
+
+  if (auto rc = flag_parser.parseArgv(argc - 1, argv + 1); !rc) {
+    std::cerr << "ERROR: " << rc.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  FontInfo font;
+  if (!font_load(DefaultFont::SANS_REGULAR, &font)) {
+    std::cerr << "ERROR: no system font found" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /* measure shaping rather than the run cache */
+  shaped_run_cache()->setCapacity(0);
+
+  /* axis labels: numbers and timestamps */
+  std::mt19937_64 rng(1);
+  std::uniform_real_distribution<double> dist_value(-1000, 1000);
+  std::uniform_int_distribution<int> dist_time(0, 86399);
+
+  std::vector<std::string> labels_ascii;
+  for (size_t i = 0; i < flag_count; ++i) {
+    if (i % 2) {
+      labels_ascii.emplace_back(StringUtil::format("$0", dist_value(rng)));
+    } else {
+      auto t = dist_time(rng);
+      char label[16];
+      snprintf(label, sizeof(label), "%02i:%02i:%02i", t / 3600, t / 60 % 60, t % 60);
+      labels_ascii.emplace_back(label);
+    }
+  }
+
+  bench_shaper("text_shaper/ascii/harfbuzz", labels_ascii, font, false);
+  bench_shaper("text_shaper/ascii/simple", labels_ascii, font, true);
+
+  /* labels that are not in the simple table always go through HarfBuzz */
+  std::vector<std::string> labels_cyrillic(
+      flag_count,
+      "\xd0\x9c\xd0\xbe\xd1\x81\xd0\xba\xd0\xb2\xd0\xb0");
+
+  bench_shaper("text_shaper/cyrillic/harfbuzz", labels_cyrillic, font, false);
+  bench_shaper("text_shaper/cyrillic/simple", labels_cyrillic, font, true);
+
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,388 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <string.h>
+#include "source/plotfx.h"
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static const char* kConfig = R"(
+  width: 800px;
+  height: 400px;
+  x: xs;
+  y: ys;
+
+  layer {
+    type: lines;
+  }
+)";
+
+std::string render(plotfx_t* ctx) {
+  char path[] = "/tmp/plotfx_test_api_XXXXXX";
+  auto fd = mkstemp(path);
+  EXPECT(fd >= 0);
+  close(fd);
+
+  EXPECT(plotfx_render_file(ctx, path, "svg"));
+
+  std::ifstream file(path);
+  std::string svg((std::istreambuf_iterator<char>(file)), {});
+  unlink(path);
+  return svg;
+}
+
+void setvar(plotfx_t* ctx, const char* name, const double* v, size_t n, bool borrow) {
+  if (borrow) {
+    plotfx_setvar_f64v_borrowed(ctx, name, strlen(name), v, n);
+  } else {
+    plotfx_setvar_f64v(ctx, name, strlen(name), v, n);
+  }
+}
+
+void test_setvar_undefined() {
+  auto ctx = plotfx_init();
+  EXPECT(!plotfx_configure(ctx, kConfig));
+  EXPECT(strstr(plotfx_geterror(ctx), "xs") != nullptr);
+  plotfx_destroy(ctx);
+}
+
+void test_setvar_borrowed() {
+  double xs[] = { 0, 1, 2, 3 };
+  double ys[] = { 10, 30, 20, 40 };
+
+  auto ctx_copy = plotfx_init();
+  auto ctx_borrow = plotfx_init();
+  for (auto ctx : { ctx_copy, ctx_borrow }) {
+    setvar(ctx, "xs", xs, 4, ctx == ctx_borrow);
+    setvar(ctx, "ys", ys, 4, ctx == ctx_borrow);
+    EXPECT(plotfx_configure(ctx, kConfig));
+  }
+
+  auto svg = render(ctx_copy);
+  EXPECT_EQ(svg, render(ctx_borrow));
+
+  /* updated values are picked up after setting the variable again */
+  ys[1] = 50;
+  setvar(ctx_copy, "ys", ys, 4, false);
+  setvar(ctx_borrow, "ys", ys, 4, true);
+
+  auto svg_updated = render(ctx_copy);
+  EXPECT(svg_updated != svg);
+  EXPECT_EQ(svg_updated, render(ctx_borrow));
+
+  plotfx_destroy(ctx_copy);
+  plotfx_destroy(ctx_borrow);
+}
+
+void test_setvar_str() {
+  const char* labels[] = { "a", "b", "c" };
+  size_t label_lens[] = { 1, 1, 1 };
+  double ys[] = { 1, 2, 3 };
+
+  auto ctx = plotfx_init();
+  plotfx_setvar_strv(ctx, "xs", 2, labels, label_lens, 3);
+  plotfx_setvar_f64v(ctx, "ys", 2, ys, 3);
+  EXPECT(plotfx_configure(ctx, kConfig));
+  EXPECT(!render(ctx).empty());
+  plotfx_destroy(ctx);
+}
+
+void test_append() {
+  double xs[] = { 0, 1, 2, 3, 4, 5 };
+  double ys[] = { 10, 30, 20, 40, -5, 60 };
+
+  auto ctx_full = plotfx_init();
+  setvar(ctx_full, "xs", xs, 6, false);
+  setvar(ctx_full, "ys", ys, 6, false);
+  EXPECT(plotfx_configure(ctx_full, kConfig));
+
+  auto ctx_append = plotfx_init();
+  setvar(ctx_append, "xs", xs, 3, true);
+  setvar(ctx_append, "ys", ys, 3, false);
+  EXPECT(plotfx_configure(ctx_append, kConfig));
+  EXPECT(!render(ctx_append).empty());
+
+  for (size_t i = 3; i < 6; ++i) {
+    EXPECT(plotfx_append_f64v(ctx_append, "xs", 2, xs + i, 1));
+    EXPECT(plotfx_append_f64v(ctx_append, "ys", 2, ys + i, 1));
+  }
+
+  EXPECT_EQ(render(ctx_full), render(ctx_append));
+
+  /* the loaded document was updated in place */
+  EXPECT_EQ(plotfx_getstat(ctx_append, "document_loads"), 1);
+  EXPECT_EQ(plotfx_getstat(ctx_append, "document_updates"), 1);
+
+  /* only variables that were set can be appended to */
+  EXPECT(!plotfx_append_f64v(ctx_append, "zs", 2, xs, 1));
+  EXPECT(strstr(plotfx_geterror(ctx_append), "zs") != nullptr);
+
+  const char* label = "x";
+  plotfx_setvar_str(ctx_append, "label", 5, label, 1);
+  EXPECT(!plotfx_append_f64v(ctx_append, "label", 5, xs, 1));
+
+  plotfx_destroy(ctx_full);
+  plotfx_destroy(ctx_append);
+}
+
+void test_append_groups() {
+  static const char* config = R"(
+    width: 800px;
+    height: 400px;
+    x: xs;
+    y: ys;
+    group: gs;
+
+    layer {
+      type: lines;
+    }
+
+    layer {
+      type: points;
+    }
+  )";
+
+  double xs[] = { 0, 1, 2, 3, 4, 5, 6 };
+  double ys[] = { 10, 30, 20, 40, -5, 60, 25 };
+  double gs[] = { 1, 2, 1, 2, 2, 1, 3 };
+
+  auto ctx_append = plotfx_init();
+  setvar(ctx_append, "xs", xs, 3, false);
+  setvar(ctx_append, "ys", ys, 3, false);
+  setvar(ctx_append, "gs", gs, 3, false);
+  EXPECT(plotfx_configure(ctx_append, config));
+  EXPECT(!render(ctx_append).empty());
+
+  /* the first appended values belong to existing groups, the last one starts
+   * a new group, which loads the document again */
+  size_t len = 3;
+  for (size_t n : { 6, 7 }) {
+    auto ctx_full = plotfx_init();
+    setvar(ctx_full, "xs", xs, n, false);
+    setvar(ctx_full, "ys", ys, n, false);
+    setvar(ctx_full, "gs", gs, n, false);
+    EXPECT(plotfx_configure(ctx_full, config));
+
+    EXPECT(plotfx_append_f64v(ctx_append, "xs", 2, xs + len, n - len));
+    EXPECT(plotfx_append_f64v(ctx_append, "ys", 2, ys + len, n - len));
+    EXPECT(plotfx_append_f64v(ctx_append, "gs", 2, gs + len, n - len));
+    EXPECT_EQ(render(ctx_full), render(ctx_append));
+    plotfx_destroy(ctx_full);
+    len = n;
+  }
+
+  EXPECT_EQ(plotfx_getstat(ctx_append, "document_loads"), 2);
+  EXPECT_EQ(plotfx_getstat(ctx_append, "document_updates"), 1);
+
+  plotfx_destroy(ctx_append);
+}
+
+void test_cull_stats() {
+  static const char* config = R"(
+    width: 800px;
+    height: 400px;
+    x: xs;
+    y: ys;
+
+    layer {
+      type: points;
+    }
+  )";
+
+  /* the last three points are drawn on top of the first three */
+  double xs[] = { 0, 5, 10, 0, 5, 10, 2 };
+  double ys[] = { 1, 2, 3, 1, 2, 3, 4 };
+
+  auto ctx = plotfx_init();
+  setvar(ctx, "xs", xs, 7, false);
+  setvar(ctx, "ys", ys, 7, false);
+  EXPECT(plotfx_configure(ctx, config));
+  EXPECT(!render(ctx).empty());
+  EXPECT_EQ(plotfx_getstat(ctx, "marks_drawn"), 4);
+  EXPECT_EQ(plotfx_getstat(ctx, "marks_culled"), 3);
+  EXPECT_EQ(plotfx_getstat(ctx, "unknown"), 0);
+  plotfx_destroy(ctx);
+}
+
+void test_data_cache_stats() {
+  std::string path = "/tmp/plotfx_test_api_" + std::to_string(getpid()) + ".csv";
+  {
+    std::ofstream csv(path);
+    csv << "a,b\n1,2\n3,4\n";
+  }
+
+  auto config = R"(
+    width: 800px;
+    height: 400px;
+    x: csv()" + path + R"(, a);
+    y: csv()" + path + R"(, b);
+
+    layer {
+      type: points;
+    }
+  )";
+
+  /* the file is loaded once and then served from the cache */
+  auto ctx = plotfx_init();
+  EXPECT(plotfx_configure(ctx, config.c_str()));
+  EXPECT(!render(ctx).empty());
+  EXPECT_EQ(plotfx_getstat(ctx, "csv_cache_misses"), 1);
+  EXPECT(plotfx_getstat(ctx, "csv_cache_hits") >= 1);
+  EXPECT_EQ(plotfx_getstat(ctx, "binary_cache_misses"), 0);
+  plotfx_destroy(ctx);
+  unlink(path.c_str());
+}
+
+void test_parse_error_stats() {
+  std::string path = "/tmp/plotfx_test_api_" + std::to_string(getpid()) + ".csv";
+  {
+    std::ofstream csv(path);
+    csv << "name,value,mixed\na,1,1\nb,2,x\nc,3,\nd,4,y\n";
+  }
+
+  auto config = R"(
+    width: 800px;
+    height: 400px;
+    data: csv()" + path + R"();
+    x: value;
+    y: value;
+
+    layer {
+      type: points;
+    }
+  )";
+
+  /* text-only and numeric columns have no parse errors */
+  auto ctx = plotfx_init();
+  EXPECT(plotfx_configure(ctx, config.c_str()));
+  EXPECT_EQ(plotfx_getstat(ctx, "parse_errors"), 2);
+  EXPECT_EQ(plotfx_getstat(ctx, "parse_errors:mixed"), 2);
+  EXPECT_EQ(plotfx_getstat(ctx, "parse_errors:name"), 0);
+  EXPECT_EQ(std::string(plotfx_getstat_column(ctx, 0)), "mixed");
+  EXPECT(plotfx_getstat_column(ctx, 1) == nullptr);
+  plotfx_destroy(ctx);
+  unlink(path.c_str());
+}
+
+std::string read_file(const std::string& path) {
+  std::ifstream file(path);
+  return std::string((std::istreambuf_iterator<char>(file)), {});
+}
+
+void test_render_files() {
+  double xs[] = { 0, 5, 10 };
+  double ys[] = { 1, 2, 3 };
+
+  auto ctx = plotfx_init();
+  setvar(ctx, "xs", xs, 3, false);
+  setvar(ctx, "ys", ys, 3, false);
+  EXPECT(plotfx_configure(ctx, kConfig));
+
+  std::string path = "/tmp/plotfx_test_api_" + std::to_string(getpid());
+  auto full = path + "_full.svg";
+  auto half = path + "_half.svg";
+  const char* paths[] = { full.c_str(), half.c_str() };
+  double scales[] = { 1.0, 0.5 };
+  EXPECT(plotfx_render_files(ctx, paths, nullptr, scales, 2));
+
+  auto svg_full = read_file(full);
+  auto svg_half = read_file(half);
+  unlink(full.c_str());
+  unlink(half.c_str());
+
+  EXPECT(svg_full == render(ctx));
+  EXPECT(svg_full.find("width=\"800.000000\"") != std::string::npos);
+  EXPECT(svg_half.find("width=\"400.000000\"") != std::string::npos);
+
+  const char* bad_paths[] = { "/tmp/plotfx_test_api.jpg" };
+  EXPECT(!plotfx_render_files(ctx, bad_paths, nullptr, nullptr, 1));
+  plotfx_destroy(ctx);
+}
+
+void test_write_binary() {
+  double xs[] = { 0, 5, 10 };
+  double ys[] = { 1, 2, 3 };
+
+  auto ctx = plotfx_init();
+  setvar(ctx, "xs", xs, 3, false);
+  setvar(ctx, "ys", ys, 3, false);
+  EXPECT(plotfx_configure(ctx, kConfig));
+
+  std::string path = "/tmp/plotfx_test_api_" + std::to_string(getpid()) + ".bin";
+  const char* columns[] = { "xs", "ys" };
+  EXPECT(plotfx_write_binary(ctx, path.c_str(), columns, 2));
+
+  const char* bad_columns[] = { "xs", "zs" };
+  EXPECT(!plotfx_write_binary(ctx, path.c_str(), bad_columns, 2));
+  EXPECT(std::string(plotfx_geterror(ctx)).find("zs") != std::string::npos);
+
+  /* the written file renders the same chart as the variables */
+  auto config = R"(
+    width: 800px;
+    height: 400px;
+    x: binary()" + path + R"(, xs);
+    y: binary()" + path + R"(, ys);
+
+    layer {
+      type: lines;
+    }
+  )";
+
+  auto ctx_file = plotfx_init();
+  EXPECT(plotfx_configure(ctx_file, config.c_str()));
+  EXPECT(render(ctx_file) == render(ctx));
+  plotfx_destroy(ctx_file);
+  plotfx_destroy(ctx);
+  unlink(path.c_str());
+}
+
+int main() {
+  test_setvar_undefined();
+  test_setvar_borrowed();
+  test_setvar_str();
+  test_append();
+  test_append_groups();
+  test_cull_stats();
+  test_data_cache_stats();
+  test_parse_error_stats();
+  test_render_files();
+  test_write_binary();
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,148 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include "source/data_binary.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+std::string temp_path() {
+  char path[] = "/tmp/plotfx_test_binary_XXXXXX";
+  auto fd = mkstemp(path);
+  EXPECT(fd >= 0);
+  close(fd);
+  return path;
+}
+
+void test_roundtrip() {
+  auto path = temp_path();
+
+  auto x = std::make_shared<Series>(
+      series_from_text(std::vector<Value>{ "1.5", "", "-3" }));
+  auto y = std::make_shared<Series>(
+      series_from_text(std::vector<Value>{ "10", "20", "30" }));
+  auto label = std::make_shared<Series>(
+      series_from_text(std::vector<Value>{ "a", "", "ccc" }));
+
+  EXPECT(binary_write(path, { { "x", x }, { "y", y }, { "label", label } }));
+
+  SeriesMap data;
+  EXPECT(binary_read(path, &data));
+  EXPECT_EQ(data.size(), 3);
+
+  const auto& rx = *data["x"];
+  EXPECT(rx.type == SeriesType::FLOAT64);
+  EXPECT_EQ(rx.length, 3);
+  EXPECT(rx.f64 == x->f64);
+  EXPECT(!series_is_valid(rx, 1));
+  EXPECT(series_is_valid(rx, 2));
+
+  const auto& ry = *data["y"];
+  EXPECT(ry.type == SeriesType::INT64);
+  EXPECT(ry.i64 == y->i64);
+  EXPECT(ry.validity.empty());
+
+  const auto& rlabel = *data["label"];
+  EXPECT(rlabel.type == SeriesType::TEXT);
+  EXPECT(rlabel.text == label->text);
+
+  unlink(path.c_str());
+}
+
+void test_byte_order() {
+  auto path = temp_path();
+  auto x = std::make_shared<Series>(series_from_float({ 1.0 }));
+  EXPECT(binary_write(path, { { "x", x } }));
+
+  std::string contents;
+  {
+    std::ifstream file(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(file), {});
+  }
+
+  /* the version, the column count and the values are little-endian */
+  EXPECT(contents.substr(8, 8) == std::string("\x01\0\0\0\x01\0\0\0", 8));
+  EXPECT(
+      contents.substr(contents.size() - 8) ==
+      std::string("\0\0\0\0\0\0\xf0\x3f", 8));
+
+  SeriesMap data;
+  EXPECT(binary_read(path, &data));
+  EXPECT(data["x"]->f64 == std::vector<double>({ 1.0 }));
+  unlink(path.c_str());
+}
+
+void test_invalid() {
+  auto path = temp_path();
+  auto x = std::make_shared<Series>(
+      series_from_text(std::vector<Value>{ "1", "2", "3" }));
+
+  EXPECT(binary_write(path, { { "x", x } }));
+
+  std::string contents;
+  {
+    std::ifstream file(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(file), {});
+  }
+
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size() - 8);
+  }
+
+  SeriesMap data;
+  EXPECT(!binary_read(path, &data));
+
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "x,y\n1,2\n";
+  }
+
+  EXPECT(!binary_read(path, &data));
+  unlink(path.c_str());
+}
+
+int main() {
+  test_roundtrip();
+  test_byte_order();
+  test_invalid();
+  return EXIT_SUCCESS;
+}
+
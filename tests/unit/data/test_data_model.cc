@@ -0,0 +1,256 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include "source/data_model.h"
+#include "source/domain.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_parse_number() {
+  double vf;
+  int64_t vi;
+  EXPECT(value_parse_int("-42", &vi));
+  EXPECT_EQ(vi, -42);
+  EXPECT(value_parse_int("+7", &vi));
+  EXPECT_EQ(vi, 7);
+  EXPECT(!value_parse_int("1.5", &vi));
+  EXPECT(value_parse_float("1.5e3", &vf));
+  EXPECT_EQ(vf, 1500);
+  EXPECT(value_parse_float(".25", &vf));
+  EXPECT_EQ(vf, 0.25);
+  EXPECT(!value_parse_float("1,5", &vf));
+  EXPECT(value_parse_float(" 5", &vf));
+  EXPECT_EQ(vf, 5);
+  EXPECT(value_parse_float("+5", &vf));
+  EXPECT_EQ(vf, 5);
+  EXPECT(value_parse_int(" 5", &vi));
+  EXPECT_EQ(vi, 5);
+  EXPECT(value_parse_int("\t+5", &vi));
+  EXPECT_EQ(vi, 5);
+  EXPECT(!value_parse_float("5 ", &vf));
+  EXPECT(!value_parse_float("+ 5", &vf));
+  EXPECT(!value_parse_float(" ", &vf));
+  EXPECT(!value_parse_float("", &vf));
+  EXPECT(!value_parse_float("+-1", &vf));
+}
+
+void test_value_to_float() {
+  EXPECT_EQ(value_to_float("2.5"), 2.5);
+  EXPECT_EQ(value_to_float(" 12px"), 12);
+  EXPECT_EQ(value_to_float("abc"), 0);
+  EXPECT_EQ(value_to_float("1e999"), 0);
+  EXPECT_EQ(value_from_float(0.5), "0.500000");
+}
+
+void test_series_types() {
+  auto s_int = series_from_text(std::vector<Value>{ "1", "", "-3" });
+  EXPECT(s_int.type == SeriesType::INT64);
+  EXPECT(!series_is_valid(s_int, 1));
+  EXPECT_EQ(s_int.parse_errors, 0);
+
+  auto s_float = series_from_text(std::vector<Value>{ "1", "2.5" });
+  EXPECT(s_float.type == SeriesType::FLOAT64);
+  EXPECT_EQ(s_float.f64[0], 1);
+
+  auto s_text = series_from_text(std::vector<Value>{ "1", "x", "2", "", "y" });
+  EXPECT(s_text.type == SeriesType::TEXT);
+  EXPECT_EQ(s_text.parse_errors, 2);
+  EXPECT_EQ(s_text.text[1], "x");
+}
+
+void test_series_leading_space() {
+  /* columns of a CSV file with ", " separators stay numeric */
+  auto s = series_from_text(std::vector<Value>{ " 2", " 5", "+3", " 5.25" });
+  EXPECT(s.type == SeriesType::FLOAT64);
+  EXPECT_EQ(s.parse_errors, 0);
+  EXPECT(s.f64 == std::vector<double>({ 2, 5, 3, 5.25 }));
+  EXPECT_EQ(value_to_float(" 5"), 5);
+  EXPECT_EQ(value_to_float("+5"), 5);
+}
+
+void test_series_numeric_text() {
+  /* numeric columns don't keep their text; labels are formatted */
+  auto s = series_from_text(std::vector<Value>{ "1.50", "007", "" });
+  EXPECT(s.type == SeriesType::FLOAT64);
+  EXPECT(s.text.empty());
+  EXPECT_EQ(series_value_at(s, 0), "1.5");
+  EXPECT_EQ(series_value_at(s, 1), "7");
+  EXPECT_EQ(series_value_at(s, 2), "");
+
+  /* integer columns stay exact beyond 2^53 */
+  auto s_int = series_from_text(std::vector<Value>{ "9007199254740993" });
+  EXPECT(s_int.type == SeriesType::INT64);
+  EXPECT_EQ(series_value_at(s_int, 0), "9007199254740993");
+
+  /* concatenated chunks give the same result as a single parse */
+  std::vector<Value> values = { "9007199254740993", "0.5" };
+  auto whole = series_from_text(values);
+  std::vector<Series> parts;
+  parts.emplace_back(series_from_text(std::vector<Value>{ values[0] }));
+  parts.emplace_back(series_from_text(std::vector<Value>{ values[1] }));
+  auto c = series_concat(std::move(parts));
+  EXPECT(c.type == whole.type);
+  EXPECT(c.f64 == whole.f64);
+  EXPECT(series_to_text(c) == series_to_text(whole));
+}
+
+void test_series_concat() {
+  std::vector<Series> parts;
+  parts.emplace_back(series_from_text(std::vector<Value>{ "1", "" }));
+  parts.emplace_back(series_from_text(std::vector<Value>{ "2.5" }));
+
+  auto s = series_concat(std::move(parts));
+  EXPECT(s.type == SeriesType::FLOAT64);
+  EXPECT_EQ(s.length, 3);
+  EXPECT_EQ(s.f64[2], 2.5);
+  EXPECT(series_is_valid(s, 0));
+  EXPECT(!series_is_valid(s, 1));
+}
+
+void test_series_summary() {
+  auto s = series_from_text(std::vector<Value>{ "3", "", "-1" });
+  EXPECT_EQ(*series_summarize(s).min, -1);
+  EXPECT_EQ(*series_summarize(s).max, 3);
+
+  double values[] = { 7.5, -2 };
+  EXPECT(series_append_float(&s, values, 2));
+  EXPECT(s.type == SeriesType::FLOAT64);
+  EXPECT_EQ(s.length, 5);
+  EXPECT(series_is_valid(s, 4));
+  EXPECT(!series_is_valid(s, 1));
+  EXPECT_EQ(series_summarize(s).length, 5);
+  EXPECT_EQ(*series_summarize(s).min, -2);
+  EXPECT_EQ(*series_summarize(s).max, 7.5);
+
+  auto labels = series_from_text(std::vector<Value>{ "b", "a", "b" });
+  EXPECT(!series_append_float(&labels, values, 1));
+}
+
+void test_series_summary_simd() {
+  std::vector<Value> values;
+  for (size_t i = 0; i < 300; ++i) {
+    switch (i % 7) {
+      case 0:
+        values.emplace_back("");
+        break;
+      case 3:
+        values.emplace_back("nan");
+        break;
+      default:
+        values.emplace_back(std::to_string(double(i) - 100.5));
+        break;
+    }
+  }
+
+  /* value 0 is missing, the extremes are values 1 and 299 */
+  auto s = series_from_text(values);
+  EXPECT(s.type == SeriesType::FLOAT64);
+  EXPECT_EQ(*series_summarize(s).min, -99.5);
+  EXPECT_EQ(*series_summarize(s).max, 198.5);
+
+  auto empty = series_from_text(std::vector<Value>{ "", "nan" });
+  EXPECT(!series_summarize(empty).min);
+}
+
+void test_series_dictionary() {
+  auto s = series_from_text(std::vector<Value>{ "b", "a", "b", "c", "a" });
+  const auto& dict = series_dictionary(s);
+  EXPECT_EQ(dict.dict.size(), 3);
+  EXPECT_EQ(dict.dict[0], "b");
+  EXPECT_EQ(dict.dict[2], "c");
+  EXPECT(dict.codes == std::vector<uint32_t>({ 0, 1, 0, 2, 1 }));
+
+  auto groups = series_group(s);
+  EXPECT_EQ(groups.size(), 3);
+  EXPECT_EQ(groups[1].key, "a");
+  EXPECT(groups[1].index == std::vector<size_t>({ 1, 4 }));
+
+  auto numbers = series_from_text(std::vector<Value>{ "1", "", "1" });
+  EXPECT(series_dictionary(numbers).codes == std::vector<uint32_t>({ 0, 1, 0 }));
+  EXPECT_EQ(series_dictionary(numbers).dict[1], "");
+}
+
+void test_series_projection_cache() {
+  DomainConfig domain;
+  domain.kind = DomainKind::LINEAR;
+  domain.min = 0;
+  domain.max = 100;
+
+  Series s;
+  double values[] = { 10, 20, 30 };
+  EXPECT(series_append_float(&s, values, 3));
+  EXPECT(s.cache_projections);
+
+  auto p1 = domain_project(domain, s, 0, 200, false);
+  EXPECT(p1 == std::vector<double>({ 20, 40, 60 }));
+  EXPECT_EQ(s.projections.size(), 1);
+
+  /* values projected before the append are reused */
+  s.projections[0].values[0] = -1;
+  double more[] = { 50 };
+  EXPECT(series_append_float(&s, more, 1));
+  auto p2 = domain_project(domain, s, 0, 200, false);
+  EXPECT(p2 == std::vector<double>({ -1, 40, 60, 100 }));
+
+  /* a different domain or screen range is projected from scratch */
+  domain.max = 50;
+  auto p3 = domain_project(domain, s, 0, 200, false);
+  EXPECT(p3 == std::vector<double>({ 40, 80, 120, 200 }));
+  EXPECT_EQ(s.projections.size(), 2);
+
+  /* series that are not appended to don't cache projections */
+  auto fixed = series_from_float({ 10, 20 });
+  domain_project(domain, fixed, 0, 200, false);
+  EXPECT(fixed.projections.empty());
+}
+
+int main() {
+  test_parse_number();
+  test_value_to_float();
+  test_series_types();
+  test_series_leading_space();
+  test_series_numeric_text();
+  test_series_concat();
+  test_series_summary();
+  test_series_summary_simd();
+  test_series_dictionary();
+  test_series_projection_cache();
+  return EXIT_SUCCESS;
+}
+
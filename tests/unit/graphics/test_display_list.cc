@@ -0,0 +1,114 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include "graphics/display_list.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_record_replay() {
+  DisplayList list;
+  LayerRef recorder;
+  EXPECT(layer_bind_recorder(400, 300, 96, Measure(11), &list, &recorder));
+
+  layer_ops::BrushStrokeOp stroke;
+  stroke.clip = Rectangle(0, 0, 400, 300);
+  stroke.path.moveTo(1, 2);
+  stroke.path.lineTo(3, 4);
+  stroke.style.line_width = Measure(2);
+  EXPECT(recorder->apply(stroke) == OK);
+
+  layer_ops::BrushFillBatchOp batch;
+  batch.shapes = { 0, 2 };
+  batch.path.moveTo(5, 6);
+  batch.path.arcTo(1, 1, 4, 0, 1);
+  batch.path.moveTo(7, 8);
+  batch.style.color = Color::fromRGB(1, 0, 0);
+  EXPECT(recorder->apply(batch) == OK);
+
+  layer_ops::TextSpanOp text;
+  text.text = "hello";
+  text.position = Point(10, 20);
+  text.style.font.font_family_css = "sans-serif";
+  EXPECT(recorder->apply(text) == OK);
+
+  EXPECT(recorder->apply(layer_ops::SubmitOp{}) == OK);
+  EXPECT_EQ(list.op_count, 3);
+  EXPECT_EQ(list.width, 400);
+
+  std::vector<layer_ops::Op> ops;
+  auto rc = display_list_visit(list, [&ops] (const auto& op) {
+    ops.emplace_back(op);
+    return OK;
+  });
+
+  EXPECT(rc);
+  EXPECT_EQ(ops.size(), 3);
+
+  auto stroke_r = std::get<layer_ops::BrushStrokeOp>(ops[0]);
+  EXPECT_EQ(stroke_r.path.size(), 2);
+  EXPECT_EQ(stroke_r.path.coefficients()[3], 4);
+  EXPECT_EQ(stroke_r.clip.w, 400);
+  EXPECT_EQ(double(stroke_r.style.line_width), 2);
+
+  auto batch_r = std::get<layer_ops::BrushFillBatchOp>(ops[1]);
+  EXPECT(batch_r.shapes == batch.shapes);
+  EXPECT_EQ(batch_r.path.size(), 3);
+  EXPECT_EQ(batch_r.path.coefficientCount(), 9);
+  EXPECT(batch_r.style.color == batch.style.color);
+
+  auto text_r = std::get<layer_ops::TextSpanOp>(ops[2]);
+  EXPECT_EQ(text_r.text, "hello");
+  EXPECT_EQ(text_r.position.y, 20);
+  EXPECT_EQ(text_r.style.font.font_family_css, "sans-serif");
+}
+
+void test_corrupt_list() {
+  DisplayList list;
+  list.data = { 1, 2, 3 };
+
+  auto rc = display_list_visit(list, [] (const auto& op) { return OK; });
+  EXPECT(!rc);
+}
+
+int main() {
+  test_record_replay();
+  test_corrupt_list();
+  return EXIT_SUCCESS;
+}
+
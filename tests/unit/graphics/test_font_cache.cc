@@ -0,0 +1,90 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include "graphics/font_cache.h"
+#include "graphics/font_lookup.h"
+
+using namespace plotfx;
+using namespace plotfx::text;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_font_cache(const std::string& font_file) {
+  FontCache cache(2);
+
+  FontRef a;
+  EXPECT(cache.getFont(font_file, 12, 96, &a));
+  EXPECT(a->ft_face != nullptr);
+  EXPECT(a->hb_font != nullptr);
+
+  FontRef b;
+  EXPECT(cache.getFont(font_file, 12, 96, &b));
+  EXPECT(a == b);
+  EXPECT_EQ(cache.getStats().hits, 1);
+  EXPECT_EQ(cache.getStats().misses, 1);
+
+  /* a different size is a different entry; a third one evicts the oldest */
+  FontRef c;
+  EXPECT(cache.getFont(font_file, 14, 96, &c));
+  EXPECT(a != c);
+  EXPECT(cache.getFont(font_file, 12, 192, &c));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.getStats().evictions, 1);
+
+  /* the evicted font stays valid while it is referenced */
+  EXPECT(a->ft_face->size != nullptr);
+
+  cache.setCapacity(0);
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT(cache.getFont(font_file, 12, 96, &b));
+  EXPECT(a != b);
+  EXPECT_EQ(cache.getStats().misses, 4);
+
+  EXPECT(!cache.getFont("/nonexistent.ttf", 12, 96, &b));
+}
+
+int main() {
+  FontInfo font;
+  if (!font_load(DefaultFont::SANS_REGULAR, &font)) {
+    std::cerr << "WARNING: no system font found, skipping test" << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  test_font_cache(font.font_file);
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,139 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <fstream>
+#include <iostream>
+#include "graphics/font_lookup.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static void set_mtime(const std::string& path, time_t t) {
+  struct timeval tv[2] = {{t, 0}, {t, 0}};
+  EXPECT(utimes(path.c_str(), tv) == 0);
+}
+
+/* returns the names of the files in the directory */
+static std::vector<std::string> list_files(const std::string& path) {
+  std::vector<std::string> files;
+  auto dir = opendir(path.c_str());
+  EXPECT(dir != nullptr);
+
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (entry->d_type == DT_REG) {
+      files.emplace_back(entry->d_name);
+    }
+  }
+
+  closedir(dir);
+  return files;
+}
+
+void test_font_lookup_cache_file(const std::string& tmpdir) {
+  auto cache_file = tmpdir + "/fontcache";
+  auto font_dir = tmpdir + "/fonts/a/b";
+  EXPECT(mkdir((tmpdir + "/fonts").c_str(), 0755) == 0);
+  EXPECT(mkdir((tmpdir + "/fonts/a").c_str(), 0755) == 0);
+  EXPECT(mkdir(font_dir.c_str(), 0755) == 0);
+  set_mtime(font_dir, 1000000000);
+
+  /* the first lookup queries fontconfig and writes the cache file */
+  font_lookup_set_cache_file(cache_file);
+  std::string file1;
+  if (!findFontSystem("sans-serif", &file1)) {
+    std::cerr << "WARNING: no system font found, skipping test" << std::endl;
+    return;
+  }
+
+  EXPECT_EQ(font_lookup_get_stats().misses, 1);
+  EXPECT(std::ifstream(cache_file).good());
+
+  /* reloading the cache file answers the lookup without fontconfig */
+  font_lookup_set_cache_file(cache_file);
+  std::string file2;
+  EXPECT(findFontSystem("sans-serif", &file2));
+  EXPECT_EQ(file1, file2);
+  EXPECT_EQ(font_lookup_get_stats().hits, 1);
+  EXPECT_EQ(font_lookup_get_stats().misses, 1);
+
+  /* a change in a nested font directory invalidates the cache file */
+  set_mtime(font_dir, 1000000001);
+  font_lookup_set_cache_file(cache_file);
+  std::string file3;
+  EXPECT(findFontSystem("sans-serif", &file3));
+  EXPECT_EQ(file1, file3);
+  EXPECT_EQ(font_lookup_get_stats().hits, 1);
+  EXPECT_EQ(font_lookup_get_stats().misses, 2);
+
+  /* the rewritten cache file is valid again */
+  font_lookup_set_cache_file(cache_file);
+  EXPECT(findFontSystem("sans-serif", &file3));
+  EXPECT_EQ(font_lookup_get_stats().hits, 2);
+  EXPECT_EQ(font_lookup_get_stats().misses, 2);
+
+  /* no temporary files are left behind */
+  EXPECT(list_files(tmpdir) == std::vector<std::string>{ "fontcache" });
+
+  /* a cache file that can't be written is ignored */
+  font_lookup_set_cache_file(tmpdir + "/nonexistent/fontcache");
+  EXPECT(findFontSystem("sans-serif", &file3));
+  EXPECT_EQ(font_lookup_get_stats().misses, 3);
+  EXPECT(list_files(tmpdir) == std::vector<std::string>{ "fontcache" });
+
+  font_lookup_set_cache_file("");
+}
+
+int main() {
+  char tmpdir[] = "/tmp/plotfx_test_font_lookup_XXXXXX";
+  if (!mkdtemp(tmpdir)) {
+    std::cerr << "ERROR: mkdtemp failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /* fontconfig reads user fonts from $XDG_DATA_HOME/fonts */
+  setenv("XDG_DATA_HOME", tmpdir, 1);
+
+  test_font_lookup_cache_file(tmpdir);
+
+  std::string cleanup = std::string("rm -rf ") + tmpdir;
+  return system(cleanup.c_str()) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include <math.h>
+#include "graphics/rasterize.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+static uint32_t pixel_at(Rasterizer* raster, int64_t x, int64_t y) {
+  cairo_surface_flush(raster->cr_surface);
+  auto data = cairo_image_surface_get_data(raster->cr_surface);
+  auto stride = cairo_image_surface_get_stride(raster->cr_surface);
+  return reinterpret_cast<const uint32_t*>(data + y * stride)[x];
+}
+
+void test_marker_sprites_distinct_sizes() {
+  const size_t width = 1000;
+  const size_t height = 1000;
+  const size_t count = 10000;
+
+  /* every marker has a different radius and color */
+  layer_ops::BrushFillBatchOp batch;
+  batch.clip = Rectangle(0, 0, width, height);
+  batch.style.color = Color::fromRGB(0.2, 0.4, 0.8);
+  for (size_t i = 0; i < count; ++i) {
+    auto x = 5.0 + (i % 100) * 10;
+    auto y = 5.0 + (i / 100) * 10;
+    auto r = 1.0 + 3.0 * i / count;
+    batch.shapes.push_back(batch.path.size());
+    batch.path.moveTo(x + r, y);
+    batch.path.arcTo(x, y, r, 0, M_PI * 2);
+  }
+
+  Rasterizer raster(width, height, 96, std::make_shared<text::TextShaper>());
+  EXPECT(raster.fillPaths(batch) == OK);
+
+  /* radii are rounded to 1/8px, so 3px of radii need at most 25 sprites */
+  EXPECT(raster.marker_sprites.size() <= 25);
+  EXPECT(raster.marker_sprite_pixels <= kMarkerSpriteCacheMaxPixels);
+
+  for (size_t i = 0; i < count; ++i) {
+    EXPECT(pixel_at(&raster, 5 + (i % 100) * 10, 5 + (i / 100) * 10) != 0);
+  }
+}
+
+void test_marker_sprites_budget() {
+  const size_t width = 1000;
+  const size_t height = 1000;
+  const size_t count = 2000;
+
+  /* large markers in many colors exceed the sprite budget */
+  Rasterizer raster(width, height, 96, std::make_shared<text::TextShaper>());
+  for (size_t i = 0; i < count; ++i) {
+    auto x = 20.0 + (i % 40) * 24;
+    auto y = 20.0 + (i / 40) * 19;
+    layer_ops::BrushFillBatchOp batch;
+    batch.clip = Rectangle(0, 0, width, height);
+    batch.style.color = Color::fromRGB(double(i) / count, 0.5, 0.5);
+    batch.shapes.push_back(0);
+    batch.path.moveTo(x + 12, y);
+    batch.path.arcTo(x, y, 12, 0, M_PI * 2);
+    EXPECT(raster.fillPaths(batch) == OK);
+  }
+
+  EXPECT(raster.marker_sprites.size() < count);
+  EXPECT(raster.marker_sprite_pixels <= kMarkerSpriteCacheMaxPixels);
+
+  /* markers beyond the budget are still drawn */
+  for (size_t i = 0; i < count; ++i) {
+    EXPECT(pixel_at(&raster, 20 + (i % 40) * 24, 20 + (i / 40) * 19) != 0);
+  }
+}
+
+int main() {
+  test_marker_sprites_distinct_sizes();
+  test_marker_sprites_budget();
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,100 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include "graphics/path.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_path_commands() {
+  Path path;
+  EXPECT(path.empty());
+  EXPECT(path.begin() == path.end());
+
+  path.moveTo(1, 2);
+  path.lineTo(3, 4);
+  path.arcTo(5, 6, 7, 0, 1);
+  path.closePath();
+  path.lineTo(8, 9);
+  EXPECT_EQ(path.size(), 5);
+
+  auto iter = path.begin();
+  auto cmd = *iter++;
+  EXPECT(cmd.command == PathCommand::MOVE_TO);
+  EXPECT_EQ(cmd[0], 1);
+  EXPECT_EQ(cmd[1], 2);
+
+  cmd = *iter++;
+  EXPECT(cmd.command == PathCommand::LINE_TO);
+  EXPECT_EQ(cmd[1], 4);
+
+  cmd = *iter++;
+  EXPECT(cmd.command == PathCommand::ARC_TO);
+  EXPECT_EQ(cmd[0], 5);
+  EXPECT_EQ(cmd[2], 7);
+  EXPECT_EQ(cmd[4], 1);
+
+  cmd = *iter++;
+  EXPECT(cmd.command == PathCommand::CLOSE);
+
+  cmd = *iter++;
+  EXPECT(cmd.command == PathCommand::LINE_TO);
+  EXPECT_EQ(cmd[0], 8);
+  EXPECT_EQ(cmd[1], 9);
+  EXPECT(iter == path.end());
+}
+
+void test_path_packed() {
+  Path path;
+  path.reserve(1000);
+  for (size_t i = 0; i < 1000; ++i) {
+    path.lineTo(i, i * 2);
+  }
+
+  /* two coefficients per vertex, stored back to back */
+  EXPECT_EQ(path.coefficients()[1998], 999);
+  EXPECT_EQ(path.coefficients()[1999], 1998);
+  EXPECT(sizeof(PathCommand) == 1);
+}
+
+int main(int argc, char** argv) {
+  test_path_commands();
+  test_path_packed();
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,249 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "graphics/font_lookup.h"
+#include "graphics/font_metrics.h"
+#include "graphics/text_layout.h"
+#include "graphics/text_shaper.h"
+
+using namespace plotfx;
+using namespace plotfx::text;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+void test_shaped_run_cache(const FontInfo& font) {
+  auto cache = shaped_run_cache();
+  cache->clear();
+  auto stats = cache->getStats();
+
+  /* measuring and then laying out a label shapes it once */
+  TextShaper shaper;
+  Rectangle bbox;
+  EXPECT(text_measure_span("1234.5", font, 16, 96, &shaper, &bbox) == OK);
+  EXPECT(bbox.w > 0);
+  EXPECT(bbox.h > 0);
+
+  double x_end = 0;
+  auto rc = layoutText(
+      "1234.5",
+      0,
+      0,
+      font,
+      16,
+      96,
+      TextDirection::LTR,
+      &shaper,
+      [&x_end] (const GlyphPlacement& g) { x_end = g.x; });
+
+  EXPECT(rc == OK);
+  EXPECT(x_end > 0 && x_end < bbox.w);
+  EXPECT_EQ(cache->getStats().misses, stats.misses + 1);
+  EXPECT_EQ(cache->getStats().hits, stats.hits + 1);
+
+  /* other shapers use the same cache; other sizes are separate entries */
+  TextShaper shaper2;
+  ShapedRunRef run;
+  EXPECT(shaper2.shapeRun("1234.5", font, 16, 96, &run) == OK);
+  EXPECT_EQ(run->glyphs.size(), 6);
+  EXPECT_EQ(run->extents.w, bbox.w);
+  EXPECT(shaper2.shapeRun("1234.5", font, 17, 96, &run) == OK);
+  EXPECT(run->extents.w > bbox.w);
+  EXPECT_EQ(cache->getStats().misses, stats.misses + 2);
+  EXPECT_EQ(cache->size(), 2);
+}
+
+void test_font_metrics_embedded() {
+  ShapedRun run;
+  EXPECT(font_metrics_shape(kFontMetricsSansRegular, "1", 16, 96, &run));
+  EXPECT_EQ(run.glyphs.size(), 1);
+  EXPECT_EQ(run.glyphs[0].advance_x, 570 / 64.0);
+  EXPECT_EQ(run.extents.w, 570 / 64.0);
+  EXPECT(run.extents.y < 0);
+  EXPECT(run.extents.h > 16);
+
+  /* kerned pairs are narrower than the sum of their advances */
+  EXPECT(font_metrics_shape(kFontMetricsSansRegular, "11", 16, 96, &run));
+  EXPECT(run.extents.w < 2 * 570 / 64.0);
+  EXPECT_EQ(run.glyphs[0].codepoint, 0);
+
+  /* characters outside of the table are not shaped */
+  EXPECT(!font_metrics_shape(kFontMetricsSansRegular, "3.9\xc2\xb0""C", 16, 96, &run));
+
+  /* embedded fonts have no file until one is needed */
+  FontInfo font;
+  EXPECT(font_load(DefaultFont::SANS_BOLD, FontMetricsMode::EMBEDDED, &font));
+  EXPECT(font.font_file.empty());
+  EXPECT_EQ(font.font_metrics, &kFontMetricsSansBold);
+
+  TextShaper shaper;
+  Rectangle bbox;
+  EXPECT(text_measure_span("12:00", font, 16, 96, &shaper, &bbox) == OK);
+  EXPECT(bbox.w > 0);
+}
+
+/**
+ * Compare the embedded metrics against HarfBuzz shaping the font file the
+ * metrics were taken from. Skipped unless that font (Arial) is installed
+ */
+void test_font_metrics_tolerance(DefaultFont font_name, const FontMetrics& metrics) {
+  FontInfo font;
+  if (!font_load(font_name, &font)) {
+    return;
+  }
+
+  TextShaper shaper;
+  shaper.setSimpleShaping(false);
+
+  FontRef font_entry;
+  EXPECT(shaper.getFontCache()->getFont(font.font_file, 16, 96, &font_entry));
+  if (std::string(font_entry->ft_face->family_name) != "Arial") {
+    std::cerr << "WARNING: Arial not found, skipping embedded metrics test" << std::endl;
+    return;
+  }
+
+  auto width_error = [&] (const std::string& text, double font_size) {
+    ShapedRun embedded;
+    EXPECT(font_metrics_shape(metrics, text, font_size, 96, &embedded));
+
+    ShapedRunRef shaped;
+    EXPECT(shaper.shapeRun(text, font, font_size, 96, &shaped) == OK);
+    EXPECT_EQ(embedded.glyphs.size(), shaped->glyphs.size());
+    EXPECT_EQ(embedded.extents.y, shaped->extents.y);
+    EXPECT_EQ(embedded.extents.h, shaped->extents.h);
+    return std::make_pair(
+        std::abs(embedded.extents.w - shaped->extents.w),
+        shaped->extents.w);
+  };
+
+  for (double font_size : { 11.0, 14.666667, 16.0, 32.0 }) {
+    /* single glyphs have the same advance */
+    for (char c = 0x20; c < 0x7f; ++c) {
+      EXPECT(width_error(std::string(1, c), font_size).first <= 1 / 64.0);
+    }
+
+    /* numbers, dates and times are laid out exactly */
+    for (auto text : { "1234567890", "11:11:11", "2011-11-11", "-0.115" }) {
+      EXPECT_EQ(width_error(text, font_size).first, 0);
+    }
+
+    /* kerned pairs and labels stay within the documented tolerance */
+    std::vector<std::string> texts = {
+      "AV", "Te", "LT", "P.", "To", "Yo", "F,", "AVAWAY Toyota", "LT-Tey",
+    };
+
+    for (char a = 0x20; a < 0x7f; ++a) {
+      for (char b = 0x20; b < 0x7f; ++b) {
+        texts.emplace_back(std::string{a, b});
+      }
+    }
+
+    for (const auto& text : texts) {
+      auto [error, width] = width_error(text, font_size);
+      EXPECT(error <= kFontMetricsWidthTolerance * width + 1 / 64.0);
+    }
+  }
+}
+
+void test_simple_shaping(const FontInfo& font) {
+  TextShaper shaper_simple;
+  TextShaper shaper_hb;
+  shaper_hb.setSimpleShaping(false);
+
+  /* the simple path lays out text exactly like HarfBuzz */
+  std::vector<std::string> texts = {
+    "",
+    "1234.5",
+    "11:37:08",
+    "New York",
+    "AVAWAY Toyota",
+    "-3.9\xc2\xb0""C",
+    "Z\xc3\xbcrich",
+    "\xd0\x9c\xd0\xbe\xd1\x81\xd0\xba\xd0\xb2\xd0\xb0",
+  };
+
+  for (const auto& text : texts) {
+    for (double font_size : {11.0, 14.666667, 16.0}) {
+      shaped_run_cache()->clear();
+      ShapedRunRef a;
+      EXPECT(shaper_simple.shapeRun(text, font, font_size, 96, &a) == OK);
+
+      shaped_run_cache()->clear();
+      ShapedRunRef b;
+      EXPECT(shaper_hb.shapeRun(text, font, font_size, 96, &b) == OK);
+
+      EXPECT_EQ(a->glyphs.size(), b->glyphs.size());
+      for (size_t i = 0; i < a->glyphs.size(); ++i) {
+        EXPECT_EQ(a->glyphs[i].codepoint, b->glyphs[i].codepoint);
+        EXPECT_EQ(a->glyphs[i].advance_x, b->glyphs[i].advance_x);
+      }
+
+      EXPECT_EQ(a->extents.y, b->extents.y);
+      EXPECT_EQ(a->extents.w, b->extents.w);
+      EXPECT_EQ(a->extents.h, b->extents.h);
+    }
+  }
+
+  /* the shared cache does not serve simple runs to a HarfBuzz shaper */
+  shaped_run_cache()->clear();
+  auto misses = shaped_run_cache()->getStats().misses;
+  ShapedRunRef a;
+  EXPECT(shaper_simple.shapeRun("New York", font, 12, 96, &a) == OK);
+  ShapedRunRef b;
+  EXPECT(shaper_hb.shapeRun("New York", font, 12, 96, &b) == OK);
+  EXPECT(a != b);
+  EXPECT_EQ(shaped_run_cache()->getStats().misses, misses + 2);
+  EXPECT_EQ(shaped_run_cache()->size(), 2);
+}
+
+int main() {
+  test_font_metrics_embedded();
+  test_font_metrics_tolerance(DefaultFont::SANS_REGULAR, kFontMetricsSansRegular);
+  test_font_metrics_tolerance(DefaultFont::SANS_BOLD, kFontMetricsSansBold);
+
+  FontInfo font;
+  if (!font_load(DefaultFont::SANS_REGULAR, &font)) {
+    std::cerr << "WARNING: no system font found, skipping test" << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  test_shaped_run_cache(font);
+  test_simple_shaping(font);
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,191 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <iostream>
+#include <math.h>
+#include <numeric>
+#include "source/lod.h"
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+/* 100k samples of a sine wave squeezed into 100 pixel columns */
+void make_dense(
+    std::vector<double>* x,
+    std::vector<double>* y,
+    std::vector<size_t>* index) {
+  size_t count = 100000;
+  for (size_t i = 0; i < count; ++i) {
+    x->push_back(10 + i * 100.0 / count);
+    y->push_back(50 + 40 * sin(i * 0.01));
+  }
+
+  index->resize(count);
+  std::iota(index->begin(), index->end(), 0);
+}
+
+void test_m4() {
+  std::vector<double> x, y;
+  std::vector<size_t> index;
+  make_dense(&x, &y, &index);
+
+  auto reduced = lod_m4(x, y, index);
+  EXPECT(reduced.size() <= 100 * kLODPointsPerColumn);
+  EXPECT_EQ(reduced.front(), 0);
+  EXPECT_EQ(reduced.back(), index.size() - 1);
+  EXPECT(std::is_sorted(reduced.begin(), reduced.end()));
+
+  /* every column keeps its vertical extent */
+  for (size_t c = 10; c < 110; ++c) {
+    double min_full = INFINITY, max_full = -INFINITY;
+    double min_lod = INFINITY, max_lod = -INFINITY;
+    for (auto i : index) {
+      if (floor(x[i]) == c) {
+        min_full = std::min(min_full, y[i]);
+        max_full = std::max(max_full, y[i]);
+      }
+    }
+
+    for (auto i : reduced) {
+      if (floor(x[i]) == c) {
+        min_lod = std::min(min_lod, y[i]);
+        max_lod = std::max(max_lod, y[i]);
+      }
+    }
+
+    EXPECT_EQ(min_full, min_lod);
+    EXPECT_EQ(max_full, max_lod);
+  }
+}
+
+/* returns the minimum and maximum of y in the pixel column c */
+std::pair<double, double> column_extent(
+    const std::vector<double>& x,
+    const std::vector<double>& y,
+    const std::vector<size_t>& index,
+    size_t c) {
+  double min = INFINITY, max = -INFINITY;
+  for (auto i : index) {
+    if (floor(x[i]) == c) {
+      min = std::min(min, y[i]);
+      max = std::max(max, y[i]);
+    }
+  }
+
+  return { min, max };
+}
+
+void test_band() {
+  std::vector<double> x, y_upper;
+  std::vector<size_t> index;
+  make_dense(&x, &y_upper, &index);
+
+  /* the lower edge oscillates at a different frequency than the upper one */
+  std::vector<double> y_lower;
+  for (size_t i = 0; i < index.size(); ++i) {
+    y_lower.push_back(y_upper[i] + 5 + 5 * cos(i * 0.037));
+  }
+
+  std::vector<size_t> index_upper;
+  std::vector<size_t> index_lower;
+  lod_reduce_band(
+      LODMode::AUTO,
+      x,
+      y_upper,
+      y_lower,
+      index,
+      &index_upper,
+      &index_lower);
+
+  EXPECT(index_upper.size() <= 100 * kLODPointsPerColumn);
+  EXPECT(index_lower.size() <= 100 * kLODPointsPerColumn);
+  EXPECT_EQ(index_lower.front(), 0);
+  EXPECT_EQ(index_lower.back(), index.size() - 1);
+  EXPECT(std::is_sorted(index_lower.begin(), index_lower.end()));
+
+  /* every column keeps the vertical extent of both edges */
+  for (size_t c = 10; c < 110; ++c) {
+    EXPECT(
+        column_extent(x, y_upper, index, c) ==
+        column_extent(x, y_upper, index_upper, c));
+    EXPECT(
+        column_extent(x, y_lower, index, c) ==
+        column_extent(x, y_lower, index_lower, c));
+  }
+
+  /* reducing the band by the upper edge alone loses the lower envelope */
+  bool lower_lost = false;
+  for (size_t c = 10; c < 110; ++c) {
+    lower_lost |=
+        column_extent(x, y_lower, index, c) !=
+        column_extent(x, y_lower, index_upper, c);
+  }
+
+  EXPECT(lower_lost);
+}
+
+void test_lttb() {
+  std::vector<double> x, y;
+  std::vector<size_t> index;
+  make_dense(&x, &y, &index);
+
+  auto reduced = lod_reduce(LODMode::LTTB, x, y, index);
+  EXPECT_EQ(reduced.size(), 101 * kLODPointsPerColumn);
+  EXPECT_EQ(reduced.front(), 0);
+  EXPECT_EQ(reduced.back(), index.size() - 1);
+  EXPECT(std::is_sorted(reduced.begin(), reduced.end()));
+}
+
+void test_sparse() {
+  std::vector<double> x = { 10, 20, 20.5, 30 };
+  std::vector<double> y = { 1, 2, 3, 4 };
+  std::vector<size_t> index = { 0, 1, 2, 3 };
+
+  EXPECT(lod_reduce(LODMode::AUTO, x, y, index) == index);
+  EXPECT(lod_reduce(LODMode::OFF, x, y, index) == index);
+  EXPECT(lod_reduce(LODMode::LTTB, x, y, index) == index);
+  EXPECT(lod_reduce(LODMode::M4, x, y, index) == index);
+}
+
+int main(int argc, char** argv) {
+  test_m4();
+  test_band();
+  test_lttb();
+  test_sparse();
+  return EXIT_SUCCESS;
+}
+
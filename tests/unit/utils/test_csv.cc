@@ -0,0 +1,235 @@
+/**
+ * This file is part of the "plotfx" project
+ *   Copyright (c) 2018 Paul Asmuth.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <iostream>
+#include <utils/csv.h>
+
+using namespace plotfx;
+
+#define EXPECT(X) \
+    if (!(X)) { \
+      std::cerr << "ERROR: expectation failed: " << #X << " on line " << __LINE__ <<  std::endl; \
+      std::exit(1); \
+    }
+
+#define EXPECT_EQ(A, B) EXPECT((A) == (B))
+
+#define EXPECT_STREQ(A, B) EXPECT(std::string(A) == std::string(B))
+
+std::vector<std::vector<std::string>> parse(const std::string& input) {
+  CSVTable table;
+  if (!parseCSV(input.data(), input.size(), CSVParserConfig{}, &table)) {
+    std::cerr << "ERROR: parseCSV failed" << std::endl;
+    std::exit(1);
+  }
+
+  std::deque<std::string> unescaped;
+  std::vector<std::vector<std::string>> rows;
+  for (size_t row = 0; row < csv_row_count(table); ++row) {
+    std::vector<std::string> cells;
+    for (size_t col = 0; col < csv_column_count(table, row); ++col) {
+      cells.emplace_back(csv_cell(table, row, col, &unescaped));
+    }
+
+    rows.emplace_back(cells);
+  }
+
+  return rows;
+}
+
+void test_parse_simple() {
+  auto rows = parse("a,b,c\n1,2,3\n");
+  EXPECT_EQ(rows.size(), 2);
+  EXPECT_EQ(rows[0].size(), 3);
+  EXPECT_STREQ(rows[0][0], "a");
+  EXPECT_STREQ(rows[0][2], "c");
+  EXPECT_STREQ(rows[1][1], "2");
+}
+
+void test_parse_empty_cells() {
+  auto rows = parse(",,\n\n");
+  EXPECT_EQ(rows.size(), 2);
+  EXPECT_EQ(rows[0].size(), 3);
+  EXPECT_STREQ(rows[0][1], "");
+  EXPECT_EQ(rows[1].size(), 1);
+  EXPECT_STREQ(rows[1][0], "");
+}
+
+void test_parse_quoted() {
+  auto rows = parse("\"a,b\",c\n\"x\"\"y\",z\n");
+  EXPECT_EQ(rows.size(), 2);
+  EXPECT_EQ(rows[0].size(), 2);
+  EXPECT_STREQ(rows[0][0], "a,b");
+  EXPECT_STREQ(rows[0][1], "c");
+  EXPECT_STREQ(rows[1][0], "xy");
+}
+
+void test_parse_escaped() {
+  auto rows = parse("a\\\"b,c\\\\d\n");
+  EXPECT_EQ(rows.size(), 1);
+  EXPECT_STREQ(rows[0][0], "a\"b");
+  EXPECT_STREQ(rows[0][1], "c\\d");
+}
+
+void test_parse_unterminated_line() {
+  auto rows = parse("a,b\nc,d");
+  EXPECT_EQ(rows.size(), 2);
+  EXPECT_STREQ(rows[1][0], "c");
+  EXPECT_STREQ(rows[1][1], "d");
+}
+
+void test_parse_unterminated_empty_field() {
+  for (auto tokenizer : { CSVTokenizer::SCALAR, CSVTokenizer::AUTO }) {
+    CSVParserConfig opts;
+    opts.tokenizer = tokenizer;
+
+    std::string input = "a,b\n1,";
+    CSVTable table;
+    EXPECT(parseCSV(input.data(), input.size(), opts, &table));
+    EXPECT_EQ(csv_row_count(table), 2);
+    EXPECT_EQ(csv_column_count(table, 1), 2);
+  }
+
+  auto rows = parse("a,b\n1,");
+  EXPECT_EQ(rows.size(), 2);
+  EXPECT_EQ(rows[1].size(), 2);
+  EXPECT_STREQ(rows[1][0], "1");
+  EXPECT_STREQ(rows[1][1], "");
+
+  rows = parse(",");
+  EXPECT_EQ(rows.size(), 1);
+  EXPECT_EQ(rows[0].size(), 2);
+}
+
+void test_tokenizers_agree() {
+  /* quotes, escaped quotes and CRLF line ends at every position around the
+     16, 32 and 64 byte block boundaries of the vectorized tokenizers */
+  std::vector<std::string> segments = {
+    "\"a,b\"",
+    "\"x\\\"y\",z",
+    "\\\\,\\,",
+    "a\r\nb\r\n",
+    "\"q\r\nr\"\r\n",
+    ",,\n\n",
+    "\\a\"b,c\"",
+  };
+
+  std::vector<std::string> inputs;
+  for (const auto& segment : segments) {
+    for (size_t pad = 0; pad < 140; ++pad) {
+      auto input = std::string(pad, 'x') + segment + std::string(pad % 7, 'y');
+      inputs.emplace_back(input + "\n");
+      inputs.emplace_back(input + ",tail");
+      inputs.emplace_back(input + ",");
+    }
+  }
+
+  for (const auto& input : inputs) {
+    CSVParserConfig opts_scalar;
+    opts_scalar.tokenizer = CSVTokenizer::SCALAR;
+    CSVTable table_scalar;
+    auto rc_scalar = parseCSV(input.data(), input.size(), opts_scalar, &table_scalar);
+
+    for (auto tokenizer : { CSVTokenizer::SSE2, CSVTokenizer::AVX2 }) {
+      if (csv_tokenizer_resolve(tokenizer) != tokenizer) {
+        continue;
+      }
+
+      CSVParserConfig opts;
+      opts.tokenizer = tokenizer;
+      CSVTable table;
+      auto rc = parseCSV(input.data(), input.size(), opts, &table);
+      EXPECT_EQ(rc.isSuccess(), rc_scalar.isSuccess());
+      EXPECT(table.field_ends == table_scalar.field_ends);
+      EXPECT(table.rows == table_scalar.rows);
+    }
+  }
+}
+
+void test_parse_unterminated_quote() {
+  std::string input = "\"a,b\n";
+  CSVTable table;
+  EXPECT(!parseCSV(input.data(), input.size(), CSVParserConfig{}, &table));
+}
+
+void test_cells_are_views() {
+  std::string input = "abc,\"def\"\n";
+  CSVTable table;
+  EXPECT(parseCSV(input.data(), input.size(), CSVParserConfig{}, &table));
+
+  std::deque<std::string> unescaped;
+  auto cell = csv_cell(table, 0, 0, &unescaped);
+  EXPECT(cell.data() == input.data());
+  EXPECT(unescaped.empty());
+
+  csv_cell(table, 0, 1, &unescaped);
+  EXPECT_EQ(unescaped.size(), 1);
+}
+
+void test_parse_parallel() {
+  /* a quoted field with line separators that spans the first chunk boundary */
+  std::string input = "a,\"";
+  while (input.size() < (3 << 20)) {
+    input += "x,y\n";
+  }
+  input += "\"\n";
+
+  for (size_t i = 0; input.size() < (8 << 20); ++i) {
+    input += std::to_string(i) + ",\"q\\\"\n\",z\n";
+  }
+
+  CSVTable expected;
+  EXPECT(parseCSV(input.data(), input.size(), CSVParserConfig{}, &expected));
+
+  CSVParserConfig opts;
+  opts.threads = 4;
+  CSVTable table;
+  EXPECT(parseCSV(input.data(), input.size(), opts, &table));
+  EXPECT(table.field_ends == expected.field_ends);
+  EXPECT(table.rows == expected.rows);
+  EXPECT_EQ(csv_column_count(table, 0), 2);
+}
+
+int main() {
+  test_parse_simple();
+  test_parse_empty_cells();
+  test_parse_quoted();
+  test_parse_escaped();
+  test_parse_unterminated_line();
+  test_parse_unterminated_empty_field();
+  test_tokenizers_agree();
+  test_parse_unterminated_quote();
+  test_cells_are_views();
+  test_parse_parallel();
+  return EXIT_SUCCESS;
+}
+